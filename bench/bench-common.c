@@ -0,0 +1,128 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "cJSON.h"
+#include "config.h"
+#include "config-serialize.h"
+#include "bench-common.h"
+
+#define BENCH_MONITOR_WIDTH 1920
+#define BENCH_MONITOR_HEIGHT 1080
+
+projection_config* bench_create_config(int count_display, int grid_size) {
+    projection_config *config = (projection_config*) calloc(1, sizeof(projection_config));
+
+    config->count_display = count_display;
+    config->display = (config_display*) calloc(count_display, sizeof(config_display));
+
+    for (int i = 0; i < count_display; i++) {
+        config_display *display = &config->display[i];
+
+        display->monitor_bounds.x = i * BENCH_MONITOR_WIDTH;
+        display->monitor_bounds.w = BENCH_MONITOR_WIDTH;
+        display->monitor_bounds.h = BENCH_MONITOR_HEIGHT;
+        display->projection_enabled = 1;
+
+        display->count_virtual_screen = 1;
+        display->virtual_screens = (config_virtual_screen*) calloc(1, sizeof(config_virtual_screen));
+
+        config_virtual_screen *vs = display->virtual_screens;
+
+        vs->w = BENCH_MONITOR_WIDTH;
+        vs->h = BENCH_MONITOR_HEIGHT;
+        vs->render_input_bounds.w = BENCH_MONITOR_WIDTH;
+        vs->render_input_bounds.h = BENCH_MONITOR_HEIGHT;
+        vs->background_clear_color.a = 1.0;
+
+        vs->color_matrix.r_to_r = 1.0;
+        vs->color_matrix.g_to_g = 1.0;
+        vs->color_matrix.b_to_b = 1.0;
+        vs->color_matrix.r_exposure = 1.0;
+        vs->color_matrix.g_exposure = 1.0;
+        vs->color_matrix.b_exposure = 1.0;
+
+        config_point_mapping *mapping = &vs->monitor_position;
+        int count_points = grid_size * grid_size;
+
+        mapping->count_points = count_points;
+        mapping->input_points = (config_point*) calloc(count_points, sizeof(config_point));
+        mapping->output_points = (config_point*) calloc(count_points, sizeof(config_point));
+        mapping->output_horizontal_adjust_factor = 1.0;
+        mapping->output_vertical_adjust_factor = 1.0;
+
+        for (int p = 0; p < count_points; p++) {
+            double u = (p % grid_size) / (double) (grid_size - 1);
+            double v = (p / grid_size) / (double) (grid_size - 1);
+
+            mapping->input_points[p].x = u * BENCH_MONITOR_WIDTH;
+            mapping->input_points[p].y = v * BENCH_MONITOR_HEIGHT;
+
+            // Gentle barrel distortion, like a real calibration
+            double dx = u - 0.5;
+            double dy = v - 0.5;
+            double k = 1.0 - 0.05 * (dx * dx + dy * dy);
+
+            mapping->output_points[p].x = (0.5 + dx * k) * BENCH_MONITOR_WIDTH;
+            mapping->output_points[p].y = (0.5 + dy * k) * BENCH_MONITOR_HEIGHT;
+        }
+
+        vs->count_blends = 1;
+        vs->blends = (config_blend*) calloc(1, sizeof(config_blend));
+        vs->blends[0].position.w = 200;
+        vs->blends[0].position.h = BENCH_MONITOR_HEIGHT;
+        vs->blends[0].curve_exponent = 2.2;
+    }
+
+    return config;
+}
+
+int bench_write_config(const char *file_path, projection_config *config) {
+    FILE *file;
+    open_file(&file, file_path, "wb");
+
+    if (file == NULL) {
+        return 0;
+    }
+
+    cJSON *json = serialize_projection_config(config);
+    char *json_string = cJSON_PrintUnformatted(json);
+
+    size_t length = strlen(json_string);
+    int success = fwrite(json_string, 1, length, file) == length;
+
+    fclose(file);
+    free(json_string);
+    cJSON_Delete(json);
+
+    return success;
+}
+
+void bench_stats_init(bench_stats *stats, const char *name) {
+    memset(stats, 0, sizeof(bench_stats));
+
+    stats->name = name;
+    stats->min_ms = INFINITY;
+}
+
+void bench_stats_add(bench_stats *stats, unsigned long long begin_ns, unsigned long long end_ns) {
+    double ms = (end_ns - begin_ns) / 1.0e6;
+
+    stats->count++;
+    stats->sum_ms += ms;
+
+    if (ms < stats->min_ms) {
+        stats->min_ms = ms;
+    }
+
+    if (ms > stats->max_ms) {
+        stats->max_ms = ms;
+    }
+}
+
+void bench_stats_print(bench_stats *stats) {
+    printf(
+        "%-32s runs %4i  min %10.3fms  mean %10.3fms  max %10.3fms\n",
+        stats->name, stats->count, stats->min_ms, stats->sum_ms / stats->count, stats->max_ms);
+}
@@ -0,0 +1,25 @@
+#include "config-structs.h"
+
+#ifndef _BENCH_COMMON_H_
+#define _BENCH_COMMON_H_
+
+// Synthetic calibration: count_display displays with one virtual screen each,
+// warped by a grid_size x grid_size point mapping.
+projection_config* bench_create_config(int count_display, int grid_size);
+
+// Writes config as JSON to file_path. Returns 0 on failure.
+int bench_write_config(const char *file_path, projection_config *config);
+
+typedef struct {
+    const char *name;
+    int count;
+    double min_ms;
+    double max_ms;
+    double sum_ms;
+} bench_stats;
+
+void bench_stats_init(bench_stats *stats, const char *name);
+void bench_stats_add(bench_stats *stats, unsigned long long begin_ns, unsigned long long end_ns);
+void bench_stats_print(bench_stats *stats);
+
+#endif
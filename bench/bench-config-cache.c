@@ -0,0 +1,63 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "clock.h"
+#include "config.h"
+#include "config-cache.h"
+#include "bench-common.h"
+
+// Cold (JSON parse + triangulation + cache write) vs warm (mapped cache)
+// startup of load_config.
+// Usage: bench-config-cache [displays] [grid size] [iterations]
+int main(int argc, char **argv) {
+    int count_display = argc > 1 ? atoi(argv[1]) : 6;
+    int grid_size = argc > 2 ? atoi(argv[2]) : 64;
+    int iterations = argc > 3 ? atoi(argv[3]) : 20;
+
+    const char *config_path = "bench-config-cache.json";
+    const char *cache_path = "bench-config-cache.json" CONFIG_CACHE_EXTENSION;
+
+    projection_config *config = bench_create_config(count_display, grid_size);
+
+    if (!bench_write_config(config_path, config)) {
+        fprintf(stderr, "Failed to write %s\n", config_path);
+        return 1;
+    }
+
+    free_projection_config(config);
+
+    printf("%i displays, %ix%i points each\n", count_display, grid_size, grid_size);
+
+    bench_stats cold, warm;
+    bench_stats_init(&cold, "cold (parse + triangulate)");
+    bench_stats_init(&warm, "warm (compiled cache)");
+
+    for (int i = 0; i < iterations; i++) {
+        remove(cache_path);
+
+        unsigned long long begin_ns = get_time_ns();
+        config = load_config(config_path);
+        bench_stats_add(&cold, begin_ns, get_time_ns());
+
+        free_projection_config(config);
+
+        begin_ns = get_time_ns();
+        config = load_config(config_path);
+        bench_stats_add(&warm, begin_ns, get_time_ns());
+
+        if (config == NULL || config->cache_mapping == NULL) {
+            fprintf(stderr, "Compiled cache was not used\n");
+            return 1;
+        }
+
+        free_projection_config(config);
+    }
+
+    bench_stats_print(&cold);
+    bench_stats_print(&warm);
+
+    remove(config_path);
+    remove(cache_path);
+
+    return 0;
+}
@@ -0,0 +1,155 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "clock.h"
+#include "config.h"
+#include "config-mesh.h"
+#include "config-mesh-cache.h"
+#include "config-surface.h"
+#include "parallel.h"
+#include "bench-common.h"
+
+#define BENCH_SCREENS 4
+
+// Moves every point by up to a quarter pixel, so the mapping is no longer a
+// grid and each seed misses the mesh cache
+static void bench_scatter_config(projection_config *config, unsigned int seed) {
+    for (int i = 0; i < config->count_display; i++) {
+        config_point_mapping *mapping = &config->display[i].virtual_screens[0].monitor_position;
+
+        for (int p = 0; p < mapping->count_points; p++) {
+            seed = (seed * 1103515245) + 12345;
+
+            double dx = (((seed >> 8) & 0xFF) / 1024.0) - 0.125;
+            double dy = (((seed >> 16) & 0xFF) / 1024.0) - 0.125;
+
+            mapping->input_points[p].x += dx;
+            mapping->input_points[p].y += dy;
+            mapping->output_points[p].x += dx;
+            mapping->output_points[p].y += dy;
+        }
+    }
+}
+
+static void bench_free_meshes(projection_config *config) {
+    for (int i = 0; i < config->count_display; i++) {
+        config_virtual_screen *vs = &config->display[i].virtual_screens[0];
+
+        config_mesh_free(&vs->mesh);
+        config_mesh_points_free(&vs->mesh_points);
+        config_surface_free(&vs->surface);
+    }
+}
+
+// Mesh build of one virtual screen, with its mesh points already normalized
+// (as loaded configs have them) and from the raw point mapping. Only the
+// first build triangulates, later ones hit the mesh cache. Also prints the
+// uploaded mesh size against one float position and uv per triangle corner.
+// Then several triangulated (non grid) screens, one after the other and
+// through config_build_meshes, which triangulates them in parallel.
+// Usage: bench-config-mesh [iterations]
+int main(int argc, char **argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 10;
+    int grid_sizes[] = { 64, 200, 500 };
+
+    for (int i = 0; i < (int) (sizeof(grid_sizes) / sizeof(grid_sizes[0])); i++) {
+        int grid_size = grid_sizes[i];
+
+        projection_config *config = bench_create_config(1, grid_size);
+        config_display *display = &config->display[0];
+        config_virtual_screen *vs = &display->virtual_screens[0];
+
+        printf("%ix%i points\n", grid_size, grid_size);
+
+        bench_stats points, triangulated, prebuilt, raw;
+        bench_stats_init(&points, "mesh points");
+        bench_stats_init(&triangulated, "mesh, triangulated");
+        bench_stats_init(&prebuilt, "mesh from mesh points, cached");
+        bench_stats_init(&raw, "mesh from point mapping, cached");
+
+        for (int j = 0; j < iterations; j++) {
+            config_mesh mesh;
+
+            unsigned long long begin_ns = get_time_ns();
+            config_mesh_points_build(display, vs, &vs->mesh_points, NULL);
+            bench_stats_add(&points, begin_ns, get_time_ns());
+
+            begin_ns = get_time_ns();
+            config_mesh_build(display, vs, &mesh, NULL);
+            bench_stats_add(j == 0 ? &triangulated : &prebuilt, begin_ns, get_time_ns());
+
+            config_mesh_free(&mesh);
+            config_mesh_points_free(&vs->mesh_points);
+
+            begin_ns = get_time_ns();
+            config_mesh_build(display, vs, &mesh, NULL);
+            bench_stats_add(&raw, begin_ns, get_time_ns());
+
+            if (j == 0) {
+                size_t indexed = (mesh.count_vertexes * 4 * sizeof(unsigned short)) + (mesh.count_indexes * sizeof(unsigned int));
+                size_t unindexed = mesh.count_indexes * 4 * sizeof(float);
+
+                printf("mesh memory: %zu bytes, %zu bytes unindexed (%.1fx)\n", indexed, unindexed, (double) unindexed / (double) indexed);
+            }
+
+            config_mesh_free(&mesh);
+        }
+
+        bench_stats_print(&points);
+        bench_stats_print(&triangulated);
+        bench_stats_print(&prebuilt);
+        bench_stats_print(&raw);
+
+        free_projection_config(config);
+    }
+
+    printf("%i scattered screens, %i threads\n", BENCH_SCREENS, parallel_count_threads());
+
+    for (int i = 0; i < (int) (sizeof(grid_sizes) / sizeof(grid_sizes[0])); i++) {
+        int grid_size = grid_sizes[i];
+
+        projection_config *config = bench_create_config(BENCH_SCREENS, grid_size);
+
+        char sequential_name[64], parallel_name[64];
+        snprintf(sequential_name, sizeof(sequential_name), "%ix%i screens, one by one", grid_size, grid_size);
+        snprintf(parallel_name, sizeof(parallel_name), "%ix%i screens, config_build_meshes", grid_size, grid_size);
+
+        bench_stats sequential, parallel;
+        bench_stats_init(&sequential, sequential_name);
+        bench_stats_init(&parallel, parallel_name);
+
+        for (int j = 0; j < iterations; j++) {
+            bench_scatter_config(config, (j * 2) + 1);
+
+            unsigned long long begin_ns = get_time_ns();
+
+            for (int k = 0; k < config->count_display; k++) {
+                config_display *display = &config->display[k];
+                config_mesh_build(display, &display->virtual_screens[0], &display->virtual_screens[0].mesh, NULL);
+            }
+
+            bench_stats_add(&sequential, begin_ns, get_time_ns());
+            bench_free_meshes(config);
+
+            bench_scatter_config(config, (j * 2) + 2);
+
+            begin_ns = get_time_ns();
+            config_build_meshes(config);
+            bench_stats_add(&parallel, begin_ns, get_time_ns());
+
+            bench_free_meshes(config);
+        }
+
+        bench_stats_print(&sequential);
+        bench_stats_print(&parallel);
+
+        free_projection_config(config);
+    }
+
+    config_mesh_cache_stats stats;
+    config_mesh_cache_get_stats(&stats);
+
+    printf("mesh cache: %llu hits, %llu misses (%llu grids, %llu incremental), %llu evictions\n", stats.hits, stats.misses, stats.grids, stats.incremental, stats.evictions);
+
+    return 0;
+}
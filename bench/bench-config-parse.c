@@ -0,0 +1,95 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cJSON.h"
+#include "clock.h"
+#include "config.h"
+#include "config-parse.h"
+#include "config-stream-parse.h"
+#include "bench-common.h"
+
+// cJSON DOM parse vs the streaming parser on configs with 10k, 100k and 1M
+// mapping points. Meshes are not built, only parsing is measured.
+// Usage: bench-config-parse [iterations]
+
+static projection_config* bench_parse_dom(const char *file_path) {
+    FILE *file;
+    open_file(&file, file_path, "rb");
+
+    fseek(file, 0L, SEEK_END);
+    size_t size = ftell(file);
+    fseek(file, 0L, SEEK_SET);
+
+    char *data = (char*) malloc(size);
+    size_t read_size = fread(data, 1, size, file);
+    fclose(file);
+
+    cJSON *json = cJSON_ParseWithLength(data, read_size);
+    free(data);
+
+    projection_config *config = (projection_config*) calloc(1, sizeof(projection_config));
+    parse_projection_config(json, config);
+
+    cJSON_Delete(json);
+
+    return config;
+}
+
+static projection_config* bench_parse_stream(const char *file_path) {
+    FILE *file;
+    open_file(&file, file_path, "rb");
+
+    projection_config *config = (projection_config*) calloc(1, sizeof(projection_config));
+
+    if (!stream_parse_projection_config(file, config, NULL)) {
+        fprintf(stderr, "Stream parse failed\n");
+        exit(1);
+    }
+
+    fclose(file);
+
+    return config;
+}
+
+int main(int argc, char **argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 5;
+    int grid_sizes[] = { 100, 317, 1000 };
+
+    const char *config_path = "bench-config-parse.json";
+
+    for (int i = 0; i < (int) (sizeof(grid_sizes) / sizeof(grid_sizes[0])); i++) {
+        int grid_size = grid_sizes[i];
+
+        projection_config *config = bench_create_config(1, grid_size);
+        bench_write_config(config_path, config);
+        free_projection_config(config);
+
+        printf("%i points\n", grid_size * grid_size);
+
+        bench_stats dom, stream;
+        bench_stats_init(&dom, "cJSON DOM");
+        bench_stats_init(&stream, "stream");
+
+        for (int j = 0; j < iterations; j++) {
+            unsigned long long begin_ns = get_time_ns();
+            config = bench_parse_dom(config_path);
+            bench_stats_add(&dom, begin_ns, get_time_ns());
+
+            free_projection_config(config);
+
+            begin_ns = get_time_ns();
+            config = bench_parse_stream(config_path);
+            bench_stats_add(&stream, begin_ns, get_time_ns());
+
+            free_projection_config(config);
+        }
+
+        bench_stats_print(&dom);
+        bench_stats_print(&stream);
+    }
+
+    remove(config_path);
+
+    return 0;
+}
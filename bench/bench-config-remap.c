@@ -0,0 +1,57 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "clock.h"
+#include "config.h"
+#include "config-mesh.h"
+#include "config-remap.h"
+#include "parallel.h"
+#include "bench-common.h"
+
+// Remap texture bake of 1080p meshes from 10k triangles up, against the
+// size of the mesh it replaces. Per frame GPU cost of both warp modes is
+// reported at runtime by the "Display N Warp" GPU measure.
+// Usage: bench-config-remap [iterations]
+int main(int argc, char **argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 10;
+    int grid_sizes[] = { 72, 160, 320 };
+
+    printf("%i worker threads\n", parallel_count_threads());
+
+    for (int i = 0; i < (int) (sizeof(grid_sizes) / sizeof(grid_sizes[0])); i++) {
+        projection_config *config = bench_create_config(1, grid_sizes[i]);
+        config_display *display = &config->display[0];
+        config_virtual_screen *vs = &display->virtual_screens[0];
+
+        config_mesh mesh;
+        config_mesh_build(display, vs, &mesh, NULL);
+
+        bench_stats bake;
+        bench_stats_init(&bake, "remap bake");
+
+        for (int j = 0; j < iterations; j++) {
+            config_remap remap;
+
+            unsigned long long begin_ns = get_time_ns();
+            config_remap_build(display, &mesh, &remap);
+            bench_stats_add(&bake, begin_ns, get_time_ns());
+
+            if (j == 0) {
+                size_t mesh_size = (mesh.count_vertexes * 4 * sizeof(unsigned short)) + (mesh.count_indexes * sizeof(unsigned int));
+                size_t remap_size = (size_t) remap.w * remap.h * 2 * sizeof(unsigned short);
+
+                printf("%ix%i points, %i triangles: mesh %zu bytes, remap %ix%i %zu bytes\n",
+                    grid_sizes[i], grid_sizes[i], mesh.count_indexes / 3, mesh_size, remap.w, remap.h, remap_size);
+            }
+
+            config_remap_free(&remap);
+        }
+
+        bench_stats_print(&bake);
+
+        config_mesh_free(&mesh);
+        free_projection_config(config);
+    }
+
+    return 0;
+}
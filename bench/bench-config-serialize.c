@@ -0,0 +1,73 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cJSON.h"
+#include "clock.h"
+#include "config.h"
+#include "config-serialize.h"
+#include "bench-common.h"
+
+// cJSON print + fwrite vs write_config, pretty and compact, on configs with
+// 10k, 100k and 1M mapping points.
+// Usage: bench-config-serialize [iterations]
+
+static void bench_write_cjson(const char *file_path, projection_config *config, int pretty) {
+    FILE *file;
+    open_file(&file, file_path, "wb");
+
+    cJSON *json = serialize_projection_config(config);
+    char *json_string = pretty ? cJSON_Print(json) : cJSON_PrintUnformatted(json);
+
+    fwrite(json_string, 1, strlen(json_string), file);
+    fclose(file);
+
+    free(json_string);
+    cJSON_Delete(json);
+}
+
+static void bench_write_stream(const char *file_path, projection_config *config, int pretty) {
+    if (!write_config(file_path, config, pretty)) {
+        fprintf(stderr, "Config write failed\n");
+        exit(1);
+    }
+}
+
+int main(int argc, char **argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 5;
+    int grid_sizes[] = { 100, 317, 1000 };
+
+    const char *config_path = "bench-config-serialize.json";
+
+    for (int i = 0; i < (int) (sizeof(grid_sizes) / sizeof(grid_sizes[0])); i++) {
+        int grid_size = grid_sizes[i];
+        projection_config *config = bench_create_config(1, grid_size);
+
+        printf("%i points\n", grid_size * grid_size);
+
+        for (int pretty = 1; pretty >= 0; pretty--) {
+            bench_stats cjson, stream;
+            bench_stats_init(&cjson, pretty ? "cJSON pretty" : "cJSON compact");
+            bench_stats_init(&stream, pretty ? "stream pretty" : "stream compact");
+
+            for (int j = 0; j < iterations; j++) {
+                unsigned long long begin_ns = get_time_ns();
+                bench_write_cjson(config_path, config, pretty);
+                bench_stats_add(&cjson, begin_ns, get_time_ns());
+
+                begin_ns = get_time_ns();
+                bench_write_stream(config_path, config, pretty);
+                bench_stats_add(&stream, begin_ns, get_time_ns());
+            }
+
+            bench_stats_print(&cjson);
+            bench_stats_print(&stream);
+        }
+
+        free_projection_config(config);
+    }
+
+    remove(config_path);
+
+    return 0;
+}
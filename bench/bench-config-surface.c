@@ -0,0 +1,61 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "clock.h"
+#include "config.h"
+#include "config-mesh.h"
+#include "config-surface.h"
+#include "parallel.h"
+#include "bench-common.h"
+
+// Bicubic surface tessellation of sparse control grids at a few tolerances,
+// and the mesh build of the dense result. Mesh builds after the first one
+// hit the mesh cache.
+// Usage: bench-config-surface [iterations]
+int main(int argc, char **argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 10;
+    int grid_sizes[] = { 8, 16, 32 };
+    double tolerances[] = { 1.0, 0.25, 0.05 };
+
+    printf("%i worker threads\n", parallel_count_threads());
+
+    for (int i = 0; i < (int) (sizeof(grid_sizes) / sizeof(grid_sizes[0])); i++) {
+        for (int j = 0; j < (int) (sizeof(tolerances) / sizeof(tolerances[0])); j++) {
+            projection_config *config = bench_create_config(1, grid_sizes[i]);
+            config_display *display = &config->display[0];
+            config_virtual_screen *vs = &display->virtual_screens[0];
+
+            vs->monitor_position.interpolation = CONFIG_POINT_MAPPING_BICUBIC;
+            vs->monitor_position.surface_tolerance = tolerances[j];
+
+            bench_stats surface, mesh;
+            bench_stats_init(&surface, "surface");
+            bench_stats_init(&mesh, "mesh");
+
+            for (int k = 0; k < iterations; k++) {
+                unsigned long long begin_ns = get_time_ns();
+                config_surface_build(&vs->monitor_position, &vs->surface, NULL);
+                bench_stats_add(&surface, begin_ns, get_time_ns());
+
+                if (k == 0) {
+                    printf("%ix%i control points, tolerance %.2fpx: %i surface points\n",
+                        grid_sizes[i], grid_sizes[i], tolerances[j], vs->surface.count_points);
+                }
+
+                begin_ns = get_time_ns();
+                config_mesh_build(display, vs, &vs->mesh, NULL);
+                bench_stats_add(&mesh, begin_ns, get_time_ns());
+
+                config_mesh_free(&vs->mesh);
+                config_surface_free(&vs->surface);
+            }
+
+            bench_stats_print(&surface);
+            bench_stats_print(&mesh);
+
+            free_projection_config(config);
+        }
+    }
+
+    return 0;
+}
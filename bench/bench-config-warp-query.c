@@ -0,0 +1,97 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "clock.h"
+#include "config.h"
+#include "config-warp-query.h"
+#include "bench-common.h"
+
+#define BENCH_QUERIES 100000
+
+// Forward then inverse point queries on meshes from 8k to 500k triangles,
+// in batches of BENCH_QUERIES random virtual screen pixels. Also prints the
+// round trip error, which should stay at rounding level.
+// Usage: bench-config-warp-query [iterations]
+int main(int argc, char **argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 10;
+    int grid_sizes[] = { 64, 200, 500 };
+
+    for (int i = 0; i < (int) (sizeof(grid_sizes) / sizeof(grid_sizes[0])); i++) {
+        projection_config *config = bench_create_config(1, grid_sizes[i]);
+        config_virtual_screen *vs = &config->display[0].virtual_screens[0];
+
+        config_warp_query query;
+
+        unsigned long long begin_ns = get_time_ns();
+        config_warp_query_build(vs, &query);
+        double build_ms = (get_time_ns() - begin_ns) / 1.0e6;
+
+        printf("%ix%i points, %i triangles, index built in %.3fms\n",
+            grid_sizes[i], grid_sizes[i], query.triangles->count_triangles, build_ms);
+
+        double *xs = (double*) malloc(BENCH_QUERIES * sizeof(double));
+        double *ys = (double*) malloc(BENCH_QUERIES * sizeof(double));
+        config_point *outputs = (config_point*) malloc(BENCH_QUERIES * sizeof(config_point));
+        unsigned int seed = 12345;
+
+        for (int j = 0; j < BENCH_QUERIES; j++) {
+            seed = (seed * 1103515245) + 12345;
+            xs[j] = ((seed >> 8) / (double) (1 << 24)) * vs->w;
+            seed = (seed * 1103515245) + 12345;
+            ys[j] = ((seed >> 8) / (double) (1 << 24)) * vs->h;
+        }
+
+        bench_stats forward, inverse;
+        bench_stats_init(&forward, "forward batch");
+        bench_stats_init(&inverse, "inverse batch");
+
+        int found = 0;
+        double max_error = 0.0;
+
+        for (int j = 0; j < iterations; j++) {
+            config_warp_query_result result;
+
+            found = 0;
+            begin_ns = get_time_ns();
+
+            for (int k = 0; k < BENCH_QUERIES; k++) {
+                if (config_warp_query_forward(&query, xs[k], ys[k], &result)) {
+                    outputs[found++] = result.point;
+                }
+            }
+
+            bench_stats_add(&forward, begin_ns, get_time_ns());
+            begin_ns = get_time_ns();
+
+            for (int k = 0; k < found; k++) {
+                config_warp_query_inverse(&query, outputs[k].x, outputs[k].y, &result);
+            }
+
+            bench_stats_add(&inverse, begin_ns, get_time_ns());
+        }
+
+        for (int k = 0; k < BENCH_QUERIES; k++) {
+            config_warp_query_result result;
+
+            if (config_warp_query_forward(&query, xs[k], ys[k], &result) &&
+                config_warp_query_inverse(&query, result.point.x, result.point.y, &result)) {
+                double error = fmax(fabs(result.point.x - xs[k]), fabs(result.point.y - ys[k]));
+                max_error = fmax(max_error, error);
+            }
+        }
+
+        bench_stats_print(&forward);
+        bench_stats_print(&inverse);
+        printf("%i of %i points mapped, round trip error %.2e px\n", found, BENCH_QUERIES, max_error);
+
+        free(xs);
+        free(ys);
+        free(outputs);
+
+        config_warp_query_free(&query);
+        free_projection_config(config);
+    }
+
+    return 0;
+}
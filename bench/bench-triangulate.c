@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#ifdef SINGLE
+#define REAL float
+#else
+#define REAL double
+#endif
+
+#define VOID void
+
+#include "triangle.h"
+
+#include "clock.h"
+#include "config-mesh-cache.h"
+#include "bench-common.h"
+
+#define BENCH_WIDTH 1920.0
+#define BENCH_HEIGHT 1080.0
+
+// Peak resident memory of the process, in bytes
+static size_t bench_peak_memory() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return counters.PeakWorkingSetSize;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return (size_t) usage.ru_maxrss;
+#else
+    return (size_t) usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+
+static REAL* bench_random_points(int count_points) {
+    REAL *points = (REAL*) malloc(count_points * 2 * sizeof(REAL));
+    unsigned int seed = 12345;
+
+    for (int i = 0; i < count_points * 2; i++) {
+        seed = (seed * 1103515245) + 12345;
+        points[i] = (REAL) (((seed >> 8) / (double) (1 << 24)) * (i % 2 ? BENCH_HEIGHT : BENCH_WIDTH));
+    }
+
+    return points;
+}
+
+// Regular grid, every cell has 4 cocircular points
+static REAL* bench_grid_points(int count_points, int *out_count_points) {
+    int size = 2;
+
+    while ((size + 1) * (size + 1) <= count_points) {
+        size++;
+    }
+
+    REAL *points = (REAL*) malloc(size * size * 2 * sizeof(REAL));
+
+    for (int i = 0; i < size * size; i++) {
+        points[i * 2] = (REAL) (((i % size) / (double) (size - 1)) * BENCH_WIDTH);
+        points[(i * 2) + 1] = (REAL) (((i / size) / (double) (size - 1)) * BENCH_HEIGHT);
+    }
+
+    *out_count_points = size * size;
+
+    return points;
+}
+
+// Triangle alone, through the same switches the mesh cache uses, on random
+// and grid point sets from 1k to 1M points. Build with and without
+// ENABLE_TRIANGLE_SINGLE to compare both triangulator configurations.
+// Usage: bench-triangulate [iterations]
+int main(int argc, char **argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 3;
+    int sizes[] = { 1000, 10000, 100000, 1000000 };
+
+    printf("triangle with %zu byte REAL, switches %s\n", sizeof(REAL), CONFIG_MESH_CACHE_TRIANGLE_SWITCHES);
+
+    for (int i = 0; i < (int) (sizeof(sizes) / sizeof(sizes[0])); i++) {
+        for (int grid = 0; grid < 2; grid++) {
+            int count_points = sizes[i];
+            REAL *points = grid ? bench_grid_points(count_points, &count_points) : bench_random_points(count_points);
+
+            char name[64];
+            snprintf(name, sizeof(name), "%s %i points", grid ? "grid" : "random", count_points);
+
+            bench_stats stats;
+            bench_stats_init(&stats, name);
+
+            int count_triangles = 0;
+
+            for (int j = 0; j < iterations; j++) {
+                struct triangulateio in, out;
+
+                memset(&in, 0, sizeof(struct triangulateio));
+                memset(&out, 0, sizeof(struct triangulateio));
+
+                in.numberofpoints = count_points;
+                in.pointlist = points;
+
+                unsigned long long begin_ns = get_time_ns();
+                triangulate(CONFIG_MESH_CACHE_TRIANGLE_SWITCHES, &in, &out, NULL);
+                bench_stats_add(&stats, begin_ns, get_time_ns());
+
+                count_triangles = out.numberoftriangles;
+                trifree(out.trianglelist);
+            }
+
+            bench_stats_print(&stats);
+
+            // Sizes grow, the peak is reached by the largest set so far
+            printf("%i triangles, points %zu bytes, triangles %zu bytes, peak memory %.1fMB\n",
+                count_triangles,
+                count_points * 2 * sizeof(REAL),
+                count_triangles * 3 * sizeof(int),
+                bench_peak_memory() / (1024.0 * 1024.0));
+
+            free(points);
+        }
+    }
+
+    return 0;
+}
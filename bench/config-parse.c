@@ -59,6 +59,30 @@ void parse_config_point_mapping(cJSON *config_point_mapping_json, config_point_m
     } else {
         out->output_vertical_adjust_factor = 1.0;
     }
+
+    cJSON *grid_columns_json = cJSON_GetObjectItemCaseSensitive(config_point_mapping_json, "grid_columns");
+
+    if (cJSON_IsNumber(grid_columns_json)) {
+        out->grid_columns = grid_columns_json->valueint;
+    } else {
+        out->grid_columns = 0;
+    }
+
+    cJSON *interpolation_json = cJSON_GetObjectItemCaseSensitive(config_point_mapping_json, "interpolation");
+
+    if (cJSON_IsNumber(interpolation_json)) {
+        out->interpolation = interpolation_json->valueint;
+    } else {
+        out->interpolation = CONFIG_POINT_MAPPING_LINEAR;
+    }
+
+    cJSON *surface_tolerance_json = cJSON_GetObjectItemCaseSensitive(config_point_mapping_json, "surface_tolerance");
+
+    if (cJSON_IsNumber(surface_tolerance_json)) {
+        out->surface_tolerance = surface_tolerance_json->valuedouble;
+    } else {
+        out->surface_tolerance = 0.0;
+    }
 }
 
 void parse_config_blend(cJSON *config_blend_json, config_blend *out) {
@@ -302,6 +326,14 @@ void parse_config_virtual_screen(cJSON *config_virtual_screen_json, config_virtu
 
     parse_config_point_mapping(cJSON_GetObjectItemCaseSensitive(config_virtual_screen_json, "monitor_position"), &out->monitor_position);
 
+    cJSON *remap_warp_json = cJSON_GetObjectItemCaseSensitive(config_virtual_screen_json, "remap_warp");
+
+    if (cJSON_IsNumber(remap_warp_json)) {
+        out->remap_warp = remap_warp_json->valueint;
+    } else {
+        out->remap_warp = 0;
+    }
+
     // Blends
     cJSON *blends = cJSON_GetObjectItemCaseSensitive(config_virtual_screen_json, "blends");
 
@@ -22,21 +22,23 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include <obs-module.h>
 #include <plugin-support.h>
 #include <stdlib.h>
+#include <stdatomic.h>
 
-#include <uv.h>
 #include <tinycthread.h>
 
 #include "debug.h"
 #include "config-structs.h"
 #include "config.h"
 #include "config-debug.h"
+#include "config-watcher.h"
 #include "monitor.h"
 #include "loop.h"
 #include "render.h"
 #include "render-obs.h"
 #include "ogl-loader.h"
+#include "trace.h"
 
-static uv_loop_t *loop;
+static char *config_file_path;
 
 static int initialized = 0;
 static int configured = 0;
@@ -47,6 +49,17 @@ static int last_height = 0;
 static projection_config *config;
 static obs_output_t *output;
 
+// Bumped when the watcher stops, config changes queued before are dropped
+static atomic_ullong watcher_generation = 0;
+
+typedef struct {
+    projection_config *config;
+    unsigned long long generation;
+} config_changed_task;
+
+static time_measure *output_data_measure;
+static time_measure *push_frame_measure;
+
 typedef struct {
     obs_output_t *output;
 } context_info;
@@ -92,6 +105,8 @@ int pool_loop(void *_) {
 
         thrd_sleep(&sleep_interval, 0);
 
+        log_measures();
+
         if (pool_running == 0 && pool_thread_running) {
             pool_running = 1;
 
@@ -138,6 +153,47 @@ void internal_lib_render_startup() {
     main_loop_start();
 }
 
+void internal_lib_render_restart_displays(projection_config *new_config) {
+    monitors_reload();
+
+    unsigned int display_mask = monitors_windows_to_recreate(config, new_config);
+
+    // Only the changed windows are recreated, the render loop is parked meanwhile
+    main_loop_detach_displays(display_mask);
+    monitors_recreate_windows(new_config, display_mask, main_loop_next_config_generation());
+
+    config = new_config;
+    main_loop_schedule_config_reload(config);
+
+    // Published first, so the loop does not adopt an older snapshot with the new windows
+    main_loop_resume_displays();
+}
+
+void internal_lib_render_apply_config(projection_config *new_config) {
+    if (config) {
+        // The render loop frees the old config once it adopts this one
+        if (config_change_requires_restart(new_config, config)) {
+            log_debug("Displays changed! restarting changed windows...");
+            internal_lib_render_restart_displays(new_config);
+        } else {
+            log_debug("New config was loaded! hot reloading...");
+
+            config = new_config;
+            main_loop_schedule_config_reload(config);
+        }
+
+        return;
+    }
+
+    log_debug("Staring engine...");
+
+    config = new_config;
+
+    internal_lib_render_startup();
+
+    configured = 1;
+}
+
 void internal_lib_render_load_config() {
     configured = 0;
 
@@ -150,41 +206,50 @@ void internal_lib_render_load_config() {
     projection_config *new_config;
 
     log_debug("Loading screen configs");
-    new_config = load_config(CONFIG_FILE);
+    new_config = load_config(config_file_path);
 
     if (new_config == NULL) {
-        generate_config(CONFIG_FILE);
-        new_config = load_config(CONFIG_FILE);
+        generate_config(config_file_path);
+        new_config = load_config(config_file_path);
     }
 
     if (new_config == NULL) {
         new_config = config_get_default();
     }
 
-    if (config) {
-        if (config_change_requires_restart(new_config, config)) {
-            internal_lib_render_shutdown();   
-            free_projection_config(config);
-        } else {
-            log_debug("New config was loaded! hot reloading...");
-            projection_config* old_config = config;
+    internal_lib_render_apply_config(new_config);
+}
 
-            config = new_config;
+void internal_lib_render_config_changed_task(void *data) {
+    config_changed_task *task = (config_changed_task*) data;
+    projection_config *new_config = task->config;
+    unsigned long long generation = task->generation;
 
-            main_loop_schedule_config_reload(config);
-            free_projection_config(old_config);
+    free(task);
 
-            return;
-        }
+    if (generation != atomic_load(&watcher_generation)) {
+        log_debug("Config file changed before the watcher stopped, dropping it\n");
+        free_projection_config(new_config);
+        return;
     }
 
-    log_debug("Staring engine...");
+    if (!configured) {
+        log_debug("Config file changed while output is stopped. Will load on start\n");
+        free_projection_config(new_config);
+        return;
+    }
 
-    config = new_config;
+    internal_lib_render_apply_config(new_config);
+}
 
-    internal_lib_render_startup();
+// Runs on the config watcher thread. GLFW windows can only be touched by the UI thread.
+void handle_config_file_changed(projection_config *new_config) {
+    config_changed_task *task = (config_changed_task*) malloc(sizeof(config_changed_task));
 
-    configured = 1;
+    task->config = new_config;
+    task->generation = atomic_load(&watcher_generation);
+
+    obs_queue_task(OBS_TASK_UI, internal_lib_render_config_changed_task, task, false);
 }
 
 const char* my_output_name(void* type_data) {
@@ -289,6 +354,9 @@ void my_output_data(void *data, struct video_data *frame) {
         return;
     }
 
+    trace_set_thread_name("OBS Video");
+    begin_measure(output_data_measure);
+
     context_info *info = (context_info*) data;
 
     int width = obs_output_get_width(info->output);
@@ -297,17 +365,18 @@ void my_output_data(void *data, struct video_data *frame) {
     uint8_t *video_data = frame->data[0];
 
     if (width && height && data && frame->linesize[0]) {
+        begin_measure(push_frame_measure);
         renders_push_frame(video_data, width, frame->linesize[0], height);
+        end_measure(push_frame_measure);
+
         if (width != last_width || height != last_height) {
             last_width = width;
             last_height = height;
-            main_loop_schedule_config_reload(config);
+            main_loop_schedule_render_resize();
         }
     }
-}
 
-void handle_uv_fs_event(uv_fs_event_t *handle, const char *filename, int events, int status) {
-    internal_lib_render_load_config();
+    end_measure(output_data_measure);
 }
 
 struct obs_output_info my_output = {
@@ -327,8 +396,12 @@ OBS_MODULE_USE_DEFAULT_LOCALE(PLUGIN_NAME, "en-US")
 
 bool obs_module_load(void)
 {
-    loop = uv_default_loop();
-    uv_run(loop, UV_RUN_DEFAULT);
+    trace_start(getenv(TRACE_ENV_VAR));
+
+    output_data_measure = create_measure("OBS Output Data");
+    push_frame_measure = create_measure("Renders Push Frame");
+
+    config_file_path = config_watcher_expand_path(CONFIG_FILE);
     glfwInit();
 
     obs_register_output(&my_output);
@@ -352,9 +425,7 @@ bool obs_module_load(void)
 
     obs_log(LOG_INFO, "plugin started successfully");
 
-    uv_fs_event_t *fs_event_req = malloc(sizeof(uv_fs_event_t));
-    uv_fs_event_init(loop, fs_event_req);
-    uv_fs_event_start(fs_event_req, handle_uv_fs_event, CONFIG_FILE, 0);
+    config_watcher_start(config_file_path, handle_config_file_changed);
 
     glfwTerminate();
 
@@ -372,13 +443,24 @@ void obs_module_unload(void)
 {
     obs_log(LOG_INFO, "plugin will unload");
 
+    config_watcher_stop();
+
+    // The watcher thread is joined, nothing queues changes anymore
+    atomic_fetch_add(&watcher_generation, 1);
+
     if (output) {
         obs_output_stop(output);
         obs_output_release(output);
         output = NULL;
     }
 
-    uv_loop_close(loop);
+    free(config_file_path);
+    config_file_path = NULL;
+
+    destroy_measure(output_data_measure);
+    destroy_measure(push_frame_measure);
+
+    trace_stop();
 
 	obs_log(LOG_INFO, "plugin unloaded");
 }
@@ -0,0 +1,112 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+
+#define ARENA_ALIGNMENT 16
+#define ARENA_ALIGN(size) (((size) + (ARENA_ALIGNMENT - 1)) & ~((size_t) ARENA_ALIGNMENT - 1))
+#define ARENA_BLOCK_HEADER ARENA_ALIGN(sizeof(arena_block))
+
+static inline char* arena_block_data(arena_block *block) {
+    return ((char*) block) + ARENA_BLOCK_HEADER;
+}
+
+static arena_block* arena_block_create(arena_block *previous, size_t size) {
+    arena_block *block = (arena_block*) malloc(ARENA_BLOCK_HEADER + size);
+
+    if (block == NULL) {
+        return NULL;
+    }
+
+    block->previous = previous;
+    block->size = size;
+    block->used = 0;
+
+    return block;
+}
+
+arena* arena_create(size_t block_size) {
+    arena *a = (arena*) malloc(sizeof(arena));
+
+    block_size = ARENA_ALIGN(block_size);
+
+    a->current = arena_block_create(NULL, block_size);
+    a->next_block_size = block_size * 2;
+    a->last = NULL;
+
+    return a;
+}
+
+void arena_destroy(arena *a) {
+    arena_block *block = a->current;
+
+    while (block) {
+        arena_block *previous = block->previous;
+        free(block);
+        block = previous;
+    }
+
+    free(a);
+}
+
+static void* arena_alloc_uninitialized(arena *a, size_t size) {
+    arena_block *block = a->current;
+
+    size = ARENA_ALIGN(size);
+
+    if (block == NULL || block->size - block->used < size) {
+        size_t block_size = a->next_block_size > size ? a->next_block_size : size;
+
+        block = arena_block_create(a->current, block_size);
+
+        if (block == NULL) {
+            return NULL;
+        }
+
+        a->current = block;
+        a->next_block_size = block_size * 2;
+    }
+
+    char *data = arena_block_data(block) + block->used;
+    block->used += size;
+
+    a->last = data;
+
+    return data;
+}
+
+void* arena_alloc(arena *a, size_t size) {
+    void *data = arena_alloc_uninitialized(a, size);
+
+    if (data) {
+        memset(data, 0, size);
+    }
+
+    return data;
+}
+
+void* arena_grow(arena *a, void *ptr, size_t size, size_t new_size) {
+    arena_block *block = a->current;
+
+    if (ptr == NULL) {
+        return arena_alloc_uninitialized(a, new_size);
+    }
+
+    // Growing arrays are usually the last allocation, extend them in place
+    if (ptr == a->last) {
+        size_t offset = a->last - arena_block_data(block);
+
+        if (ARENA_ALIGN(new_size) <= block->size - offset) {
+            block->used = offset + ARENA_ALIGN(new_size);
+            return ptr;
+        }
+    }
+
+    void *data = arena_alloc_uninitialized(a, new_size);
+
+    if (data) {
+        memcpy(data, ptr, size < new_size ? size : new_size);
+    }
+
+    return data;
+}
@@ -0,0 +1,32 @@
+#include <stddef.h>
+
+#ifndef _ARENA_H_
+#define _ARENA_H_
+
+// Bump allocator, everything allocated is freed at once by arena_destroy.
+// Not thread safe, an arena must be used by one thread at a time.
+typedef struct arena_block {
+    struct arena_block *previous;
+    size_t size;
+    size_t used;
+} arena_block;
+
+typedef struct arena {
+    arena_block *current;
+    size_t next_block_size;
+
+    // Last allocation, may grow in place
+    char *last;
+} arena;
+
+// block_size is the size of the first block, later ones double
+arena* arena_create(size_t block_size);
+void arena_destroy(arena *a);
+
+// Zeroed and aligned for any type
+void* arena_alloc(arena *a, size_t size);
+
+// Like realloc, ptr must come from a or be NULL. Bytes past size are not zeroed.
+void* arena_grow(arena *a, void *ptr, size_t size, size_t new_size);
+
+#endif
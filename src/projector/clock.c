@@ -35,6 +35,23 @@ void get_time(struct timespec* ct)
 
     return 0;
 }
+
+unsigned long long get_time_ns() {
+    LARGE_INTEGER count;
+    struct timespec ct;
+
+    // Ensure frequency is loaded
+    get_time(&ct);
+
+    if (g_counts_per_sec.QuadPart <= 0 || 0 == QueryPerformanceCounter(&count)) {
+        return 0;
+    }
+
+    unsigned long long seconds = count.QuadPart / g_counts_per_sec.QuadPart;
+    unsigned long long remainder = count.QuadPart % g_counts_per_sec.QuadPart;
+
+    return (seconds * 1000000000ULL) + ((remainder * 1000000000ULL) / g_counts_per_sec.QuadPart);
+}
 #endif
 
 #ifndef _WIN32
@@ -43,6 +60,13 @@ void get_time(struct timespec* ct) {
     clock_gettime(CLOCK_REALTIME, ct);
 }
 
+unsigned long long get_time_ns() {
+    struct timespec ct;
+    clock_gettime(CLOCK_MONOTONIC, &ct);
+
+    return (ct.tv_sec * 1000000000ULL) + ct.tv_nsec;
+}
+
 #endif // !_WIN32
 
 unsigned long long get_delta_time_ms(struct timespec* last, struct timespec* before) {
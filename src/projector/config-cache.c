@@ -0,0 +1,372 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "debug.h"
+#include "config.h"
+#include "config-cache.h"
+
+#define CONFIG_CACHE_ALIGNMENT 8
+#define CONFIG_CACHE_FNV_PRIME 1099511628211ULL
+
+typedef struct {
+    char magic[4];
+    unsigned int version;
+    unsigned long long layout;
+    unsigned long long hash;
+    unsigned long long size;
+} config_cache_header;
+
+// Pointers are stored as offsets from the file start, 0 meaning NULL.
+// Fields are relocated in place on load, the mapping is copy on write (a
+// private copy on Windows).
+typedef struct {
+    char *data;
+    size_t size;
+    size_t capacity;
+} config_cache_writer;
+
+static const char config_cache_magic[4] = { 'P', 'J', 'C', 'C' };
+
+unsigned long long config_cache_hash(unsigned long long hash, const char *data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        hash ^= (unsigned char) data[i];
+        hash *= CONFIG_CACHE_FNV_PRIME;
+    }
+
+    return hash;
+}
+
+// Struct sizes and pointer width, so a cache written by another build is ignored
+static unsigned long long config_cache_layout() {
+    size_t sizes[] = {
+        sizeof(void*),
+        sizeof(projection_config),
+        sizeof(config_display),
+        sizeof(config_virtual_screen),
+        sizeof(config_point),
+        sizeof(config_blend),
+        sizeof(config_help_line),
+        sizeof(config_black_level_adjust),
+        sizeof(config_mesh),
+    };
+
+    return config_cache_hash(CONFIG_CACHE_HASH_SEED, (const char*) sizes, sizeof(sizes));
+}
+
+static char* config_cache_path(const char *config_path) {
+    size_t length = strlen(config_path);
+    char *path = (char*) malloc(length + sizeof(CONFIG_CACHE_EXTENSION));
+
+    memcpy(path, config_path, length);
+    memcpy(path + length, CONFIG_CACHE_EXTENSION, sizeof(CONFIG_CACHE_EXTENSION));
+
+    return path;
+}
+
+// Loading
+
+// Windows reads the cache into memory instead: MoveFileEx cannot replace a
+// file with a mapped view, and the view lives as long as the config.
+static void* config_cache_map(const char *path, size_t *size) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+    if (file == INVALID_HANDLE_VALUE) {
+        return NULL;
+    }
+
+    LARGE_INTEGER file_size;
+
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0 || file_size.QuadPart > MAXDWORD) {
+        CloseHandle(file);
+        return NULL;
+    }
+
+    DWORD read_size = 0;
+    void *data = malloc((size_t) file_size.QuadPart);
+
+    if (!ReadFile(file, data, (DWORD) file_size.QuadPart, &read_size, NULL) || read_size != (DWORD) file_size.QuadPart) {
+        free(data);
+        data = NULL;
+    }
+
+    CloseHandle(file);
+
+    *size = (size_t) file_size.QuadPart;
+
+    return data;
+#else
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct stat file_stat;
+
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+        close(fd);
+        return NULL;
+    }
+
+    void *data = mmap(NULL, file_stat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (data == MAP_FAILED) {
+        return NULL;
+    }
+
+    *size = (size_t) file_stat.st_size;
+
+    return data;
+#endif
+}
+
+static void config_cache_unmap(void *data, size_t size) {
+#ifdef _WIN32
+    free(data);
+#else
+    munmap(data, size);
+#endif
+}
+
+static int config_cache_relocate(char *base, size_t size, void **field, int count, size_t item_size) {
+    uintptr_t offset = (uintptr_t) *field;
+
+    if (count < 0) {
+        return 0;
+    }
+
+    if (offset == 0) {
+        return count == 0;
+    }
+
+    size_t length = (size_t) count * item_size;
+
+    if (offset > size || length > size - offset || offset % CONFIG_CACHE_ALIGNMENT) {
+        return 0;
+    }
+
+    *field = base + offset;
+
+    return 1;
+}
+
+#define CONFIG_CACHE_RELOCATE(field, count, type) \
+    config_cache_relocate(base, size, (void**) &(field), (count), sizeof(type))
+
+static int config_cache_relocate_virtual_screen(char *base, size_t size, config_virtual_screen *vs) {
+    config_point_mapping *mapping = &vs->monitor_position;
+
+    return
+        CONFIG_CACHE_RELOCATE(mapping->input_points, mapping->count_points, config_point) &&
+        CONFIG_CACHE_RELOCATE(mapping->output_points, mapping->count_points, config_point) &&
+        CONFIG_CACHE_RELOCATE(vs->surface.input_points, vs->surface.count_points, config_point) &&
+        CONFIG_CACHE_RELOCATE(vs->surface.output_points, vs->surface.count_points, config_point) &&
+        CONFIG_CACHE_RELOCATE(vs->mesh_points.positions, vs->mesh_points.count_points * 2, float) &&
+        CONFIG_CACHE_RELOCATE(vs->mesh_points.uvs, vs->mesh_points.count_points * 2, float) &&
+        CONFIG_CACHE_RELOCATE(vs->mesh.vertexes, vs->mesh.count_vertexes * 4, unsigned short) &&
+        CONFIG_CACHE_RELOCATE(vs->mesh.indexes, vs->mesh.count_indexes, unsigned int) &&
+        CONFIG_CACHE_RELOCATE(vs->blends, vs->count_blends, config_blend) &&
+        CONFIG_CACHE_RELOCATE(vs->help_lines, vs->count_help_lines, config_help_line) &&
+        CONFIG_CACHE_RELOCATE(vs->black_level_adjusts, vs->count_black_level_adjusts, config_black_level_adjust);
+}
+
+static int config_cache_relocate_config(char *base, size_t size, projection_config *config) {
+    if (!CONFIG_CACHE_RELOCATE(config->display, config->count_display, config_display)) {
+        return 0;
+    }
+
+    for (int i = 0; i < config->count_display; i++) {
+        config_display *display = &config->display[i];
+
+        if (!CONFIG_CACHE_RELOCATE(display->virtual_screens, display->count_virtual_screen, config_virtual_screen)) {
+            return 0;
+        }
+
+        for (int j = 0; j < display->count_virtual_screen; j++) {
+            if (!config_cache_relocate_virtual_screen(base, size, &display->virtual_screens[j])) {
+                return 0;
+            }
+        }
+    }
+
+    return 1;
+}
+
+projection_config* config_cache_load(const char *config_path, unsigned long long hash) {
+    char *path = config_cache_path(config_path);
+    size_t size = 0;
+    char *base = (char*) config_cache_map(path, &size);
+
+    free(path);
+
+    if (base == NULL) {
+        return NULL;
+    }
+
+    config_cache_header *header = (config_cache_header*) base;
+    size_t config_offset = sizeof(config_cache_header);
+
+    if (size < config_offset + sizeof(projection_config) ||
+        memcmp(header->magic, config_cache_magic, sizeof(config_cache_magic)) != 0 ||
+        header->version != CONFIG_CACHE_VERSION ||
+        header->layout != config_cache_layout() ||
+        header->size != size) {
+        log_debug("Config cache invalid, ignoring it\n");
+        config_cache_unmap(base, size);
+        return NULL;
+    }
+
+    if (header->hash != hash) {
+        config_cache_unmap(base, size);
+        return NULL;
+    }
+
+    projection_config *config = (projection_config*) (base + config_offset);
+
+    if (!config_cache_relocate_config(base, size, config)) {
+        log_debug("Config cache corrupted, ignoring it\n");
+        config_cache_unmap(base, size);
+        return NULL;
+    }
+
+    config->cache_mapping = base;
+
+    return config;
+}
+
+void config_cache_release(projection_config *config) {
+    config_cache_header *header = (config_cache_header*) config->cache_mapping;
+
+    config_cache_unmap(header, header->size);
+}
+
+// Storing
+
+static size_t config_cache_append(config_cache_writer *writer, const void *data, size_t size) {
+    size_t offset = writer->size;
+    size_t aligned_size = (size + CONFIG_CACHE_ALIGNMENT - 1) & ~(size_t) (CONFIG_CACHE_ALIGNMENT - 1);
+
+    if (offset + aligned_size > writer->capacity) {
+        while (offset + aligned_size > writer->capacity) {
+            writer->capacity = writer->capacity ? writer->capacity * 2 : 4096;
+        }
+
+        writer->data = (char*) realloc(writer->data, writer->capacity);
+    }
+
+    memcpy(writer->data + offset, data, size);
+    memset(writer->data + offset + size, 0, aligned_size - size);
+
+    writer->size += aligned_size;
+
+    return offset;
+}
+
+static void config_cache_set_offset(config_cache_writer *writer, size_t field_offset, size_t target) {
+    uintptr_t value = target;
+    memcpy(writer->data + field_offset, &value, sizeof(value));
+}
+
+static void config_cache_append_array(config_cache_writer *writer, size_t field_offset, const void *data, int count, size_t item_size) {
+    size_t target = 0;
+
+    if (data && count > 0) {
+        target = config_cache_append(writer, data, (size_t) count * item_size);
+    }
+
+    config_cache_set_offset(writer, field_offset, target);
+}
+
+#define CONFIG_CACHE_APPEND_ARRAY(struct_offset, type, field, data, count, item_type) \
+    config_cache_append_array(&writer, (struct_offset) + offsetof(type, field), (data), (count), sizeof(item_type))
+
+void config_cache_store(const char *config_path, unsigned long long hash, projection_config *config) {
+    config_cache_writer writer;
+    config_cache_header header;
+
+    memset(&writer, 0, sizeof(config_cache_writer));
+    memset(&header, 0, sizeof(config_cache_header));
+
+    config_cache_append(&writer, &header, sizeof(config_cache_header));
+
+    size_t config_offset = config_cache_append(&writer, config, sizeof(projection_config));
+    config_cache_set_offset(&writer, config_offset + offsetof(projection_config, cache_mapping), 0);
+    config_cache_set_offset(&writer, config_offset + offsetof(projection_config, arena), 0);
+
+    CONFIG_CACHE_APPEND_ARRAY(config_offset, projection_config, display, config->display, config->count_display, config_display);
+
+    size_t displays_offset = (size_t) *(uintptr_t*) (writer.data + config_offset + offsetof(projection_config, display));
+
+    for (int i = 0; i < config->count_display; i++) {
+        config_display *display = &config->display[i];
+        size_t display_offset = displays_offset + (i * sizeof(config_display));
+
+        CONFIG_CACHE_APPEND_ARRAY(display_offset, config_display, virtual_screens, display->virtual_screens, display->count_virtual_screen, config_virtual_screen);
+
+        size_t vss_offset = (size_t) *(uintptr_t*) (writer.data + display_offset + offsetof(config_display, virtual_screens));
+
+        for (int j = 0; j < display->count_virtual_screen; j++) {
+            config_virtual_screen *vs = &display->virtual_screens[j];
+            config_point_mapping *mapping = &vs->monitor_position;
+            size_t vs_offset = vss_offset + (j * sizeof(config_virtual_screen));
+
+            CONFIG_CACHE_APPEND_ARRAY(vs_offset, config_virtual_screen, monitor_position.input_points, mapping->input_points, mapping->count_points, config_point);
+            CONFIG_CACHE_APPEND_ARRAY(vs_offset, config_virtual_screen, monitor_position.output_points, mapping->output_points, mapping->count_points, config_point);
+            CONFIG_CACHE_APPEND_ARRAY(vs_offset, config_virtual_screen, surface.input_points, vs->surface.input_points, vs->surface.count_points, config_point);
+            CONFIG_CACHE_APPEND_ARRAY(vs_offset, config_virtual_screen, surface.output_points, vs->surface.output_points, vs->surface.count_points, config_point);
+            CONFIG_CACHE_APPEND_ARRAY(vs_offset, config_virtual_screen, mesh_points.positions, vs->mesh_points.positions, vs->mesh_points.count_points * 2, float);
+            CONFIG_CACHE_APPEND_ARRAY(vs_offset, config_virtual_screen, mesh_points.uvs, vs->mesh_points.uvs, vs->mesh_points.count_points * 2, float);
+            CONFIG_CACHE_APPEND_ARRAY(vs_offset, config_virtual_screen, mesh.vertexes, vs->mesh.vertexes, vs->mesh.count_vertexes * 4, unsigned short);
+            CONFIG_CACHE_APPEND_ARRAY(vs_offset, config_virtual_screen, mesh.indexes, vs->mesh.indexes, vs->mesh.count_indexes, unsigned int);
+            CONFIG_CACHE_APPEND_ARRAY(vs_offset, config_virtual_screen, blends, vs->blends, vs->count_blends, config_blend);
+            CONFIG_CACHE_APPEND_ARRAY(vs_offset, config_virtual_screen, help_lines, vs->help_lines, vs->count_help_lines, config_help_line);
+            CONFIG_CACHE_APPEND_ARRAY(vs_offset, config_virtual_screen, black_level_adjusts, vs->black_level_adjusts, vs->count_black_level_adjusts, config_black_level_adjust);
+        }
+    }
+
+    memcpy(header.magic, config_cache_magic, sizeof(config_cache_magic));
+    header.version = CONFIG_CACHE_VERSION;
+    header.layout = config_cache_layout();
+    header.hash = hash;
+    header.size = writer.size;
+
+    memcpy(writer.data, &header, sizeof(config_cache_header));
+
+    char *path = config_cache_path(config_path);
+    char *temp_path = temp_file_path(path);
+
+    FILE *file;
+    open_file(&file, temp_path, "wb");
+
+    if (file == NULL) {
+        log_debug("Failed to write config cache %s\n", temp_path);
+    } else {
+        size_t written = fwrite(writer.data, 1, writer.size, file);
+        int failed = fclose(file) != 0 || written != writer.size;
+
+        // Readers only ever see a complete cache
+        failed = failed || !replace_file(temp_path, path);
+
+        if (failed) {
+            log_debug("Failed to write config cache %s\n", path);
+            remove(temp_path);
+        }
+    }
+
+    free(temp_path);
+    free(path);
+    free(writer.data);
+}
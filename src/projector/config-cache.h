@@ -0,0 +1,28 @@
+#include <stddef.h>
+
+#include "config-structs.h"
+
+#ifndef _CONFIG_CACHE_H_
+#define _CONFIG_CACHE_H_
+
+// Compiled config: the parsed structs plus the triangulated meshes, written
+// next to the JSON file. Keyed by a hash of the JSON contents, so any edit to
+// the file invalidates it.
+#define CONFIG_CACHE_EXTENSION ".cache"
+#define CONFIG_CACHE_VERSION 7
+
+// FNV-1a, can be fed in chunks. Start with CONFIG_CACHE_HASH_SEED.
+#define CONFIG_CACHE_HASH_SEED 14695981039346656037ULL
+
+unsigned long long config_cache_hash(unsigned long long hash, const char *data, size_t size);
+
+// Maps the cache of config_path. Returns NULL if missing or stale.
+// The returned config must be freed with free_projection_config.
+projection_config* config_cache_load(const char *config_path, unsigned long long hash);
+
+// Every virtual screen mesh must be built
+void config_cache_store(const char *config_path, unsigned long long hash, projection_config *config);
+
+void config_cache_release(projection_config *config);
+
+#endif
@@ -0,0 +1,605 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Same precision triangle.c is built with
+#ifdef SINGLE
+#define REAL float
+#else
+#define REAL double
+#endif
+
+#define VOID void
+#define __UINT64 __uint64
+
+#include "triangle.h"
+
+#include "tinycthread.h"
+#include "debug.h"
+#include "config.h"
+#include "config-cache.h"
+#include "config-mesh.h"
+#include "config-mesh-cache.h"
+#include "config-mesh-update.h"
+
+typedef struct {
+    char magic[4];
+    unsigned int version;
+    unsigned int count_entries;
+    unsigned int reserved;
+} config_mesh_cache_header;
+
+typedef struct {
+    unsigned long long hash;
+    int count_points;
+    int count_triangles;
+} config_mesh_cache_entry_header;
+
+static const char config_mesh_cache_magic[4] = { 'P', 'J', 'M', 'C' };
+
+static once_flag cache_once = ONCE_FLAG_INIT;
+static mtx_t cache_mutex;
+
+static config_mesh_triangles **entries = NULL;
+static int count_entries = 0;
+static int capacity_entries = 0;
+
+static unsigned long long use_counter = 0;
+static config_mesh_cache_stats stats;
+
+// Triangulated since the last load or save
+static int dirty = 0;
+static char *loaded_path = NULL;
+
+static void initialize_cache() {
+    mtx_init(&cache_mutex, 0);
+}
+
+static size_t config_mesh_triangles_memory(config_mesh_triangles *triangles) {
+    return sizeof(config_mesh_triangles) + (triangles->count_triangles * 3 * sizeof(int)) +
+        (triangles->points ? triangles->count_points * sizeof(config_point) : 0);
+}
+
+static void config_mesh_triangles_free(config_mesh_triangles *triangles) {
+    if (triangles->indexes) {
+        free(triangles->indexes);
+    }
+
+    if (triangles->points) {
+        free(triangles->points);
+    }
+
+    free(triangles);
+}
+
+static config_mesh_triangles* config_mesh_triangulate(config_point *output_points, int count_points, unsigned long long hash) {
+    config_mesh_triangles *triangles = (config_mesh_triangles*) calloc(1, sizeof(config_mesh_triangles));
+
+    triangles->hash = hash;
+    triangles->count_points = count_points;
+    triangles->points = (config_point*) malloc(count_points * sizeof(config_point));
+
+    memcpy(triangles->points, output_points, count_points * sizeof(config_point));
+
+    // Triangle exits the process on less than 3 points
+    if (count_points < 3) {
+        return triangles;
+    }
+
+    struct triangulateio in, tri;
+
+    memset(&in, 0, sizeof(struct triangulateio));
+    memset(&tri, 0, sizeof(struct triangulateio));
+
+    in.numberofpoints = count_points;
+    in.numberofpointattributes = 0;
+
+#ifdef SINGLE
+    in.pointlist = (REAL*) malloc(count_points * 2 * sizeof(REAL));
+
+    for (int i = 0; i < count_points; i++) {
+        in.pointlist[i * 2] = (REAL) output_points[i].x;
+        in.pointlist[(i * 2) + 1] = (REAL) output_points[i].y;
+    }
+#else
+    // config_point is laid out as the x, y pairs triangle reads, no copy needed
+    _Static_assert(sizeof(config_point) == 2 * sizeof(REAL), "config_point must match the triangle point list");
+    in.pointlist = (REAL*) output_points;
+#endif
+
+    // N: no output points, triangle indexes refer to the input ones.
+    // B, P: no boundary markers and segments, they are not used.
+    // Reentrant, its seed is per thread and its constants are set once
+    triangulate(CONFIG_MESH_CACHE_TRIANGLE_SWITCHES, &in, &tri, NULL);
+
+#ifdef SINGLE
+    free(in.pointlist);
+#endif
+
+    // Allocated by triangle with malloc, kept as is
+    triangles->count_triangles = tri.numberoftriangles;
+    triangles->indexes = tri.trianglelist;
+
+    return triangles;
+}
+
+// Counts the points moved from base, stops past max
+static int config_mesh_count_moved(config_mesh_triangles *base, config_point *output_points, int max) {
+    int count = 0;
+
+    for (int i = 0; i < base->count_points && count <= max; i++) {
+        count += base->points[i].x != output_points[i].x || base->points[i].y != output_points[i].y;
+    }
+
+    return count;
+}
+
+// Starts from the triangulation of base and flips edges around the moved
+// points. NULL when the moves are not local, a full triangulation is needed.
+static config_mesh_triangles* config_mesh_triangulate_moved(config_mesh_triangles *base, config_point *output_points, int count_points, unsigned long long hash) {
+    int moved[CONFIG_MESH_UPDATE_MAX_POINTS];
+    int count_moved = 0;
+
+    for (int i = 0; i < count_points && count_moved < CONFIG_MESH_UPDATE_MAX_POINTS; i++) {
+        if (base->points[i].x != output_points[i].x || base->points[i].y != output_points[i].y) {
+            moved[count_moved++] = i;
+        }
+    }
+
+    size_t indexes_size = base->count_triangles * 3 * sizeof(int);
+    int *indexes = (int*) malloc(indexes_size);
+
+    memcpy(indexes, base->indexes, indexes_size);
+
+    if (!config_mesh_update_triangles(output_points, count_points, indexes, base->count_triangles, moved, count_moved)) {
+        free(indexes);
+        return NULL;
+    }
+
+    config_mesh_triangles *triangles = (config_mesh_triangles*) calloc(1, sizeof(config_mesh_triangles));
+
+    triangles->hash = hash;
+    triangles->count_points = count_points;
+    triangles->count_triangles = base->count_triangles;
+    triangles->indexes = indexes;
+    triangles->points = (config_point*) malloc(count_points * sizeof(config_point));
+
+    memcpy(triangles->points, output_points, count_points * sizeof(config_point));
+
+    return triangles;
+}
+
+static double config_mesh_orientation(config_point *a, config_point *b, config_point *c) {
+    return ((b->x - a->x) * (c->y - a->y)) - ((b->y - a->y) * (c->x - a->x));
+}
+
+// Splits each grid cell along its shorter output diagonal, or the other one
+// when the cell is concave. NULL when the output grid folds over itself or
+// has degenerate cells, Delaunay triangulation handles those.
+static config_mesh_triangles* config_mesh_triangulate_grid(config_point *output_points, int count_points, int columns, unsigned long long hash) {
+    int rows = count_points / columns;
+    int count_triangles = (rows - 1) * (columns - 1) * 2;
+    int *indexes = (int*) malloc(count_triangles * 3 * sizeof(int));
+    int *index = indexes;
+    double sign = 0.0;
+
+    for (int r = 0; r < rows - 1; r++) {
+        for (int c = 0; c < columns - 1; c++) {
+            int i00 = (r * columns) + c;
+            int i01 = i00 + 1;
+            int i10 = i00 + columns;
+            int i11 = i10 + 1;
+
+            config_point *p00 = &output_points[i00];
+            config_point *p01 = &output_points[i01];
+            config_point *p10 = &output_points[i10];
+            config_point *p11 = &output_points[i11];
+
+            double a1 = config_mesh_orientation(p00, p01, p11);
+            double a2 = config_mesh_orientation(p00, p11, p10);
+            double b1 = config_mesh_orientation(p00, p01, p10);
+            double b2 = config_mesh_orientation(p01, p11, p10);
+
+            if (sign == 0.0) {
+                sign = a1 + a2 > 0.0 ? 1.0 : -1.0;
+            }
+
+            int split_a = (a1 * sign) > 0.0 && (a2 * sign) > 0.0;
+            int split_b = (b1 * sign) > 0.0 && (b2 * sign) > 0.0;
+
+            if (split_a && split_b) {
+                double da_x = p11->x - p00->x, da_y = p11->y - p00->y;
+                double db_x = p10->x - p01->x, db_y = p10->y - p01->y;
+
+                split_b = (db_x * db_x) + (db_y * db_y) < (da_x * da_x) + (da_y * da_y);
+                split_a = !split_b;
+            }
+
+            if (split_a) {
+                index[0] = i00; index[1] = i01; index[2] = i11;
+                index[3] = i00; index[4] = i11; index[5] = i10;
+            } else if (split_b) {
+                index[0] = i00; index[1] = i01; index[2] = i10;
+                index[3] = i01; index[4] = i11; index[5] = i10;
+            } else {
+                free(indexes);
+                return NULL;
+            }
+
+            index += 6;
+        }
+    }
+
+    config_mesh_triangles *triangles = (config_mesh_triangles*) calloc(1, sizeof(config_mesh_triangles));
+
+    triangles->hash = hash;
+    triangles->count_points = count_points;
+    triangles->count_triangles = count_triangles;
+    triangles->grid_columns = columns;
+    triangles->indexes = indexes;
+
+    return triangles;
+}
+
+// Lookup and bookkeeping, cache_mutex must be held
+
+static config_mesh_triangles* config_mesh_cache_find(unsigned long long hash, int count_points, int grid_columns) {
+    for (int i = 0; i < count_entries; i++) {
+        if (entries[i]->hash == hash && entries[i]->count_points == count_points && entries[i]->grid_columns == grid_columns) {
+            return entries[i];
+        }
+    }
+
+    return NULL;
+}
+
+// Most recently used triangulation of the same points with only a few moved,
+// e.g. the previous state of a calibration edit
+static config_mesh_triangles* config_mesh_cache_find_moved(config_point *output_points, int count_points) {
+    config_mesh_triangles *base = NULL;
+    int max = count_points / 8;
+
+    if (max > CONFIG_MESH_UPDATE_MAX_POINTS) {
+        max = CONFIG_MESH_UPDATE_MAX_POINTS;
+    }
+
+    for (int i = 0; i < count_entries; i++) {
+        config_mesh_triangles *entry = entries[i];
+
+        if (entry->grid_columns || entry->points == NULL || entry->count_points != count_points || entry->count_triangles == 0) {
+            continue;
+        }
+
+        if (base && entry->last_used < base->last_used) {
+            continue;
+        }
+
+        if (config_mesh_count_moved(entry, output_points, max) <= max) {
+            base = entry;
+        }
+    }
+
+    return base;
+}
+
+static void config_mesh_cache_insert(config_mesh_triangles *triangles) {
+    if (count_entries == capacity_entries) {
+        capacity_entries = capacity_entries ? capacity_entries * 2 : 16;
+        entries = (config_mesh_triangles**) realloc(entries, capacity_entries * sizeof(config_mesh_triangles*));
+    }
+
+    entries[count_entries++] = triangles;
+
+    stats.count_entries = count_entries;
+    stats.memory += config_mesh_triangles_memory(triangles);
+}
+
+// Least recently used first, entries in use are kept
+static void config_mesh_cache_evict() {
+    while (count_entries > CONFIG_MESH_CACHE_MAX_ENTRIES || stats.memory > CONFIG_MESH_CACHE_MAX_MEMORY) {
+        int oldest = -1;
+
+        for (int i = 0; i < count_entries; i++) {
+            if (entries[i]->references == 0 && (oldest == -1 || entries[i]->last_used < entries[oldest]->last_used)) {
+                oldest = i;
+            }
+        }
+
+        if (oldest == -1) {
+            return;
+        }
+
+        stats.memory -= config_mesh_triangles_memory(entries[oldest]);
+        stats.evictions++;
+
+        config_mesh_triangles_free(entries[oldest]);
+
+        entries[oldest] = entries[--count_entries];
+        stats.count_entries = count_entries;
+    }
+}
+
+static unsigned long long config_mesh_cache_key(config_point *output_points, int count_points) {
+    unsigned long long hash = config_cache_hash(CONFIG_CACHE_HASH_SEED, (const char*) &count_points, sizeof(count_points));
+    return config_cache_hash(hash, (const char*) output_points, count_points * sizeof(config_point));
+}
+
+config_mesh_triangles* config_mesh_cache_acquire(config_point_mapping *mapping) {
+    config_point *output_points = mapping->output_points;
+    int count_points = mapping->count_points;
+    int grid_columns = config_mesh_grid_columns(mapping);
+
+    unsigned long long hash = config_mesh_cache_key(output_points, count_points);
+
+    call_once(&cache_once, initialize_cache);
+    mtx_lock(&cache_mutex);
+
+    config_mesh_triangles *triangles = config_mesh_cache_find(hash, count_points, grid_columns);
+    config_mesh_triangles *built = NULL;
+    int incremental = 0;
+
+    if (triangles == NULL && grid_columns) {
+        mtx_unlock(&cache_mutex);
+        built = config_mesh_triangulate_grid(output_points, count_points, grid_columns, hash);
+        mtx_lock(&cache_mutex);
+
+        if (built == NULL) {
+            log_debug("Grid of %i points folds or has empty cells, triangulating\n", count_points);
+
+            grid_columns = 0;
+            triangles = config_mesh_cache_find(hash, count_points, 0);
+        }
+    }
+
+    if (triangles) {
+        stats.hits++;
+    } else {
+        stats.misses++;
+
+        if (built) {
+            stats.grids++;
+        } else {
+            config_mesh_triangles *base = config_mesh_cache_find_moved(output_points, count_points);
+
+            if (base) {
+                base->references++;
+            }
+
+            // Triangulation can take seconds on dense meshes, do not block other builds
+            mtx_unlock(&cache_mutex);
+
+            if (base) {
+                built = config_mesh_triangulate_moved(base, output_points, count_points, hash);
+                incremental = built != NULL;
+            }
+
+            if (built == NULL) {
+                built = config_mesh_triangulate(output_points, count_points, hash);
+            }
+
+            mtx_lock(&cache_mutex);
+
+            if (base) {
+                base->references--;
+                stats.incremental += incremental;
+            }
+        }
+
+        // Another thread may have built the same points meanwhile
+        triangles = config_mesh_cache_find(hash, count_points, grid_columns);
+
+        if (triangles) {
+            config_mesh_triangles_free(built);
+        } else {
+            triangles = built;
+            config_mesh_cache_insert(triangles);
+            dirty = dirty || !grid_columns;
+        }
+    }
+
+    triangles->references++;
+    triangles->last_used = ++use_counter;
+
+    config_mesh_cache_evict();
+
+    mtx_unlock(&cache_mutex);
+
+    return triangles;
+}
+
+void config_mesh_cache_release(config_mesh_triangles *triangles) {
+    mtx_lock(&cache_mutex);
+
+    triangles->references--;
+    config_mesh_cache_evict();
+
+    mtx_unlock(&cache_mutex);
+}
+
+void config_mesh_cache_get_stats(config_mesh_cache_stats *out) {
+    call_once(&cache_once, initialize_cache);
+    mtx_lock(&cache_mutex);
+
+    memcpy(out, &stats, sizeof(config_mesh_cache_stats));
+
+    mtx_unlock(&cache_mutex);
+}
+
+// Disk
+
+static char* config_mesh_cache_path(const char *config_path) {
+    size_t length = strlen(config_path);
+    char *path = (char*) malloc(length + sizeof(CONFIG_MESH_CACHE_EXTENSION));
+
+    memcpy(path, config_path, length);
+    memcpy(path + length, CONFIG_MESH_CACHE_EXTENSION, sizeof(CONFIG_MESH_CACHE_EXTENSION));
+
+    return path;
+}
+
+static config_mesh_triangles* config_mesh_cache_read_entry(FILE *file) {
+    config_mesh_cache_entry_header header;
+
+    if (fread(&header, sizeof(header), 1, file) != 1) {
+        return NULL;
+    }
+
+    // A Delaunay triangulation has less than 2 triangles per point
+    if (header.count_points < 0 || header.count_triangles < 0 || header.count_triangles / 2 > header.count_points) {
+        return NULL;
+    }
+
+    config_mesh_triangles *triangles = (config_mesh_triangles*) calloc(1, sizeof(config_mesh_triangles));
+    size_t count_indexes = (size_t) header.count_triangles * 3;
+
+    triangles->hash = header.hash;
+    triangles->count_points = header.count_points;
+    triangles->count_triangles = header.count_triangles;
+    triangles->indexes = count_indexes ? (int*) malloc(count_indexes * sizeof(int)) : NULL;
+    triangles->points = (config_point*) malloc(header.count_points * sizeof(config_point));
+
+    if ((count_indexes && fread(triangles->indexes, sizeof(int), count_indexes, file) != count_indexes) ||
+        fread(triangles->points, sizeof(config_point), header.count_points, file) != (size_t) header.count_points) {
+        config_mesh_triangles_free(triangles);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < count_indexes; i++) {
+        if (triangles->indexes[i] < 0 || triangles->indexes[i] >= header.count_points) {
+            config_mesh_triangles_free(triangles);
+            return NULL;
+        }
+    }
+
+    return triangles;
+}
+
+void config_mesh_cache_load_file(const char *config_path) {
+    call_once(&cache_once, initialize_cache);
+    mtx_lock(&cache_mutex);
+
+    // Already merged, the memory cache is newer
+    if (loaded_path && strcmp(loaded_path, config_path) == 0) {
+        mtx_unlock(&cache_mutex);
+        return;
+    }
+
+    if (loaded_path) {
+        free(loaded_path);
+    }
+
+    loaded_path = (char*) malloc(strlen(config_path) + 1);
+    strcpy(loaded_path, config_path);
+
+    char *path = config_mesh_cache_path(config_path);
+    config_mesh_cache_header header;
+    FILE *file;
+
+    open_file(&file, path, "rb");
+    free(path);
+
+    if (file == NULL) {
+        mtx_unlock(&cache_mutex);
+        return;
+    }
+
+    if (fread(&header, sizeof(header), 1, file) != 1 ||
+        memcmp(header.magic, config_mesh_cache_magic, sizeof(config_mesh_cache_magic)) != 0 ||
+        header.version != CONFIG_MESH_CACHE_VERSION) {
+        log_debug("Mesh cache invalid, ignoring it\n");
+        header.count_entries = 0;
+    }
+
+    for (unsigned int i = 0; i < header.count_entries && i < CONFIG_MESH_CACHE_MAX_ENTRIES; i++) {
+        config_mesh_triangles *triangles = config_mesh_cache_read_entry(file);
+
+        if (triangles == NULL) {
+            log_debug("Mesh cache truncated or corrupted\n");
+            break;
+        }
+
+        if (config_mesh_cache_find(triangles->hash, triangles->count_points, 0)) {
+            config_mesh_triangles_free(triangles);
+            continue;
+        }
+
+        triangles->last_used = ++use_counter;
+        config_mesh_cache_insert(triangles);
+    }
+
+    fclose(file);
+
+    config_mesh_cache_evict();
+
+    log_debug("Mesh cache loaded, %i entries\n", count_entries);
+
+    mtx_unlock(&cache_mutex);
+}
+
+void config_mesh_cache_save_file(const char *config_path) {
+    call_once(&cache_once, initialize_cache);
+    mtx_lock(&cache_mutex);
+
+    if (!dirty) {
+        mtx_unlock(&cache_mutex);
+        return;
+    }
+
+    char *path = config_mesh_cache_path(config_path);
+    char *temp_path = temp_file_path(path);
+
+    FILE *file;
+    open_file(&file, temp_path, "wb");
+
+    if (file == NULL) {
+        log_debug("Failed to write mesh cache %s\n", temp_path);
+    } else {
+        config_mesh_cache_header header;
+
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, config_mesh_cache_magic, sizeof(config_mesh_cache_magic));
+        header.version = CONFIG_MESH_CACHE_VERSION;
+        header.count_entries = 0;
+
+        for (int i = 0; i < count_entries; i++) {
+            header.count_entries += entries[i]->grid_columns == 0;
+        }
+
+        int failed = fwrite(&header, sizeof(header), 1, file) != 1;
+
+        for (int i = 0; i < count_entries && !failed; i++) {
+            config_mesh_triangles *triangles = entries[i];
+
+            if (triangles->grid_columns) {
+                continue;
+            }
+
+            config_mesh_cache_entry_header entry_header;
+            size_t count_indexes = (size_t) triangles->count_triangles * 3;
+
+            memset(&entry_header, 0, sizeof(entry_header));
+            entry_header.hash = triangles->hash;
+            entry_header.count_points = triangles->count_points;
+            entry_header.count_triangles = triangles->count_triangles;
+
+            failed = fwrite(&entry_header, sizeof(entry_header), 1, file) != 1 ||
+                (count_indexes && fwrite(triangles->indexes, sizeof(int), count_indexes, file) != count_indexes) ||
+                fwrite(triangles->points, sizeof(config_point), triangles->count_points, file) != (size_t) triangles->count_points;
+        }
+
+        failed = (fclose(file) != 0) || failed;
+        failed = failed || !replace_file(temp_path, path);
+
+        if (failed) {
+            log_debug("Failed to write mesh cache %s\n", path);
+            remove(temp_path);
+        } else {
+            dirty = 0;
+        }
+    }
+
+    free(temp_path);
+    free(path);
+
+    mtx_unlock(&cache_mutex);
+}
@@ -0,0 +1,65 @@
+#include "config-structs.h"
+
+#ifndef _CONFIG_MESH_CACHE_H_
+#define _CONFIG_MESH_CACHE_H_
+
+// Triangulations of point mappings, kept in memory across config reloads.
+// Keyed by a hash of the output points and grid columns: triangle indexes do
+// not depend on the display bounds, vertexes are rebuilt from them.
+// Grids are split into triangles directly, only other point sets go through
+// Delaunay triangulation. A point set with only a few points moved from a
+// cached one, e.g. a calibration nudge, starts from the cached triangles and
+// flips edges around the moved points.
+#define CONFIG_MESH_CACHE_EXTENSION ".meshes"
+#define CONFIG_MESH_CACHE_VERSION 2
+#define CONFIG_MESH_CACHE_MAX_ENTRIES 64
+#define CONFIG_MESH_CACHE_MAX_MEMORY (256 * 1024 * 1024)
+
+// Triangle switches: convex hull of the points, zero based, no output points,
+// boundary markers or segments, quiet
+#define CONFIG_MESH_CACHE_TRIANGLE_SWITCHES "pczNBPQ"
+
+typedef struct {
+    unsigned long long hash;
+    int count_points;
+    int count_triangles;
+
+    // Points per grid row, 0 when Delaunay triangulated
+    int grid_columns;
+
+    // 3 point indexes per triangle
+    int *indexes;
+
+    // Copy of the output points when Delaunay triangulated, to find the moves
+    config_point *points;
+
+    int references;
+    unsigned long long last_used;
+} config_mesh_triangles;
+
+typedef struct {
+    unsigned long long hits;
+    unsigned long long misses;
+    unsigned long long grids;
+    unsigned long long incremental;
+    unsigned long long evictions;
+    int count_entries;
+    size_t memory;
+} config_mesh_cache_stats;
+
+// Triangulates the points, or returns the cached triangulation. Thread safe,
+// different point sets are triangulated concurrently.
+// Must be released once the indexes are no longer needed.
+config_mesh_triangles* config_mesh_cache_acquire(config_point_mapping *mapping);
+void config_mesh_cache_release(config_mesh_triangles *triangles);
+
+void config_mesh_cache_get_stats(config_mesh_cache_stats *out);
+
+// Optional on disk copy, e.g. for the first load after the config was edited
+// offline. Loading merges into the memory cache, saving only writes when
+// something was triangulated since the last load or save. Grids are not
+// saved, they are rebuilt faster than read.
+void config_mesh_cache_load_file(const char *config_path);
+void config_mesh_cache_save_file(const char *config_path);
+
+#endif
@@ -0,0 +1,255 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "config-mesh-update.h"
+
+#define CONFIG_MESH_UPDATE_NEXT(k) ((k) == 2 ? 0 : (k) + 1)
+#define CONFIG_MESH_UPDATE_PREVIOUS(k) ((k) == 0 ? 2 : (k) - 1)
+
+typedef struct {
+    config_point *points;
+    int *indexes;
+
+    // Triangle across the edge opposite each vertex, -1 on the hull
+    int *neighbors;
+
+    // 1 when triangles are counterclockwise, -1 when clockwise
+    double sign;
+
+    // Edges to check, triangle * 3 + opposite vertex
+    int *stack;
+    int count_stack;
+    int capacity_stack;
+} config_mesh_update;
+
+static double config_mesh_update_orientation(config_point *a, config_point *b, config_point *c) {
+    return ((b->x - a->x) * (c->y - a->y)) - ((b->y - a->y) * (c->x - a->x));
+}
+
+// Positive when d is inside the circumcircle of counterclockwise a, b, c
+static double config_mesh_update_incircle(config_point *a, config_point *b, config_point *c, config_point *d) {
+    double adx = a->x - d->x, ady = a->y - d->y;
+    double bdx = b->x - d->x, bdy = b->y - d->y;
+    double cdx = c->x - d->x, cdy = c->y - d->y;
+
+    return
+        (((adx * adx) + (ady * ady)) * ((bdx * cdy) - (cdx * bdy))) +
+        (((bdx * bdx) + (bdy * bdy)) * ((cdx * ady) - (adx * cdy))) +
+        (((cdx * cdx) + (cdy * cdy)) * ((adx * bdy) - (bdx * ady)));
+}
+
+static void config_mesh_update_push(config_mesh_update *u, int triangle, int k) {
+    if (u->count_stack == u->capacity_stack) {
+        u->capacity_stack = u->capacity_stack ? u->capacity_stack * 2 : 256;
+        u->stack = (int*) realloc(u->stack, u->capacity_stack * sizeof(int));
+    }
+
+    u->stack[u->count_stack++] = (triangle * 3) + k;
+}
+
+static void config_mesh_update_replace_neighbor(config_mesh_update *u, int triangle, int previous, int next) {
+    if (triangle < 0) {
+        return;
+    }
+
+    for (int k = 0; k < 3; k++) {
+        if (u->neighbors[(triangle * 3) + k] == previous) {
+            u->neighbors[(triangle * 3) + k] = next;
+        }
+    }
+}
+
+// Checks the edge opposite vertex k of triangle t, flips it when the opposite
+// point of the neighbor lies inside the circumcircle. Returns 1 on flip.
+static int config_mesh_update_flip(config_mesh_update *u, int t, int k) {
+    int s = u->neighbors[(t * 3) + k];
+
+    if (s < 0) {
+        return 0;
+    }
+
+    int *tv = &u->indexes[t * 3];
+    int *sv = &u->indexes[s * 3];
+
+    int p = tv[k];
+    int a = tv[CONFIG_MESH_UPDATE_NEXT(k)];
+    int b = tv[CONFIG_MESH_UPDATE_PREVIOUS(k)];
+
+    int m = 0;
+
+    while (m < 3 && (sv[m] == a || sv[m] == b)) {
+        m++;
+    }
+
+    if (m == 3) {
+        return 0;
+    }
+
+    int q = sv[m];
+    config_point *points = u->points;
+
+    if (u->sign * config_mesh_update_incircle(&points[p], &points[a], &points[b], &points[q]) <= 0.0) {
+        return 0;
+    }
+
+    // Always convex in exact arithmetic, rounding may say otherwise
+    if (u->sign * config_mesh_update_orientation(&points[p], &points[a], &points[q]) <= 0.0 ||
+        u->sign * config_mesh_update_orientation(&points[p], &points[q], &points[b]) <= 0.0) {
+        return 0;
+    }
+
+    int n_bp = u->neighbors[(t * 3) + CONFIG_MESH_UPDATE_NEXT(k)];
+    int n_pa = u->neighbors[(t * 3) + CONFIG_MESH_UPDATE_PREVIOUS(k)];
+    int n_aq = u->neighbors[(s * 3) + CONFIG_MESH_UPDATE_NEXT(m)];
+    int n_qb = u->neighbors[(s * 3) + CONFIG_MESH_UPDATE_PREVIOUS(m)];
+
+    // t becomes p, a, q and s becomes p, q, b
+    tv[0] = p; tv[1] = a; tv[2] = q;
+    sv[0] = p; sv[1] = q; sv[2] = b;
+
+    u->neighbors[(t * 3) + 0] = n_aq;
+    u->neighbors[(t * 3) + 1] = s;
+    u->neighbors[(t * 3) + 2] = n_pa;
+
+    u->neighbors[(s * 3) + 0] = n_qb;
+    u->neighbors[(s * 3) + 1] = n_bp;
+    u->neighbors[(s * 3) + 2] = t;
+
+    config_mesh_update_replace_neighbor(u, n_aq, s, t);
+    config_mesh_update_replace_neighbor(u, n_bp, t, s);
+
+    // The outer edges of the quad may not be Delaunay anymore
+    config_mesh_update_push(u, t, 0);
+    config_mesh_update_push(u, t, 2);
+    config_mesh_update_push(u, s, 0);
+    config_mesh_update_push(u, s, 1);
+
+    return 1;
+}
+
+static int config_mesh_update_is_moved(int *moved, int count_moved, int point) {
+    for (int i = 0; i < count_moved; i++) {
+        if (moved[i] == point) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int config_mesh_update_triangles(config_point *points, int count_points, int *indexes, int count_triangles, int *moved, int count_moved) {
+    config_mesh_update u;
+    memset(&u, 0, sizeof(u));
+
+    u.points = points;
+    u.indexes = indexes;
+    u.neighbors = (int*) malloc(count_triangles * 3 * sizeof(int));
+    u.sign = 1.0;
+
+    // Triangles around each point, in compressed rows
+    int *first = (int*) calloc(count_points + 1, sizeof(int));
+    int *around = (int*) malloc(count_triangles * 3 * sizeof(int));
+
+    for (int i = 0; i < count_triangles * 3; i++) {
+        first[indexes[i] + 1]++;
+    }
+
+    for (int i = 0; i < count_points; i++) {
+        first[i + 1] += first[i];
+    }
+
+    int *cursor = (int*) malloc(count_points * sizeof(int));
+    memcpy(cursor, first, count_points * sizeof(int));
+
+    for (int i = 0; i < count_triangles * 3; i++) {
+        around[cursor[indexes[i]]++] = i / 3;
+    }
+
+    free(cursor);
+
+    for (int t = 0; t < count_triangles; t++) {
+        for (int k = 0; k < 3; k++) {
+            int a = indexes[(t * 3) + CONFIG_MESH_UPDATE_NEXT(k)];
+            int b = indexes[(t * 3) + CONFIG_MESH_UPDATE_PREVIOUS(k)];
+            int neighbor = -1;
+
+            for (int i = first[a]; i < first[a + 1] && neighbor < 0; i++) {
+                int s = around[i];
+
+                if (s != t && (indexes[s * 3] == b || indexes[(s * 3) + 1] == b || indexes[(s * 3) + 2] == b)) {
+                    neighbor = s;
+                }
+            }
+
+            u.neighbors[(t * 3) + k] = neighbor;
+        }
+    }
+
+    int oriented = 0;
+
+    // Winding of the unmoved triangulation, a moved point may have flipped its triangles
+    for (int t = 0; t < count_triangles && !oriented; t++) {
+        int *tv = &indexes[t * 3];
+
+        if (config_mesh_update_is_moved(moved, count_moved, tv[0]) ||
+            config_mesh_update_is_moved(moved, count_moved, tv[1]) ||
+            config_mesh_update_is_moved(moved, count_moved, tv[2])) {
+            continue;
+        }
+
+        double orientation = config_mesh_update_orientation(&points[tv[0]], &points[tv[1]], &points[tv[2]]);
+
+        if (orientation != 0.0) {
+            u.sign = orientation > 0.0 ? 1.0 : -1.0;
+            oriented = 1;
+        }
+    }
+
+    // Every triangle touches a moved point, left to a full triangulation
+    int result = oriented;
+
+    for (int i = 0; i < count_moved && result; i++) {
+        int point = moved[i];
+
+        // Unused (duplicated) points would need a new triangle
+        if (first[point] == first[point + 1]) {
+            result = 0;
+        }
+
+        for (int j = first[point]; j < first[point + 1] && result; j++) {
+            int t = around[j];
+            int *tv = &indexes[t * 3];
+
+            for (int k = 0; k < 3; k++) {
+                // Hull points change the hull, edges next to the point have no neighbor
+                if (tv[k] != point && u.neighbors[(t * 3) + k] < 0) {
+                    result = 0;
+                }
+
+                config_mesh_update_push(&u, t, k);
+            }
+
+            if (u.sign * config_mesh_update_orientation(&points[tv[0]], &points[tv[1]], &points[tv[2]]) <= 0.0) {
+                result = 0;
+            }
+        }
+    }
+
+    // Flips stay local to the moves, a runaway means something is off
+    int max_flips = count_triangles;
+
+    while (result && u.count_stack > 0) {
+        int edge = u.stack[--u.count_stack];
+
+        if (config_mesh_update_flip(&u, edge / 3, edge % 3) && --max_flips < 0) {
+            result = 0;
+        }
+    }
+
+    free(first);
+    free(around);
+    free(u.neighbors);
+    free(u.stack);
+
+    return result;
+}
@@ -0,0 +1,17 @@
+#include "config-structs.h"
+
+#ifndef _CONFIG_MESH_UPDATE_H_
+#define _CONFIG_MESH_UPDATE_H_
+
+// Incremental Delaunay update after a few points moved, e.g. calibration nudges
+#define CONFIG_MESH_UPDATE_MAX_POINTS 32
+
+// indexes is a Delaunay triangulation of the points before the moves, points
+// hold the new positions. Restores the Delaunay property with edge flips
+// around the moved points, updating indexes in place.
+// Returns 0, with indexes partially updated, when the moves can not be
+// applied locally: hull or unused points moved, every triangle has a moved
+// point, or a triangle would fold.
+int config_mesh_update_triangles(config_point *points, int count_points, int *indexes, int count_triangles, int *moved, int count_moved);
+
+#endif
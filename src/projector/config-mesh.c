@@ -0,0 +1,276 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "custom-math.h"
+#include "debug.h"
+#include "arena.h"
+#include "config-mesh-cache.h"
+#include "config-mesh.h"
+#include "config-surface.h"
+#include "parallel.h"
+
+#define CONFIG_MESH_UNORM16(value) ((unsigned short) ((CLAMP(value, 0.0f, 1.0f) * 65535.0f) + 0.5f))
+
+static void* config_mesh_alloc(arena *arena, size_t size) {
+    return arena ? arena_alloc(arena, size) : malloc(size);
+}
+
+// Detected grids: every row shares one y, every column one x, both strictly increasing
+int config_mesh_grid_columns(config_point_mapping *mapping) {
+    config_point *points = mapping->input_points;
+    int count_points = mapping->count_points;
+    int columns = mapping->grid_columns;
+
+    if (columns > 0) {
+        if (columns < 2 || count_points % columns != 0 || count_points / columns < 2) {
+            log_debug("Invalid grid columns %i for %i points, triangulating\n", columns, count_points);
+            return 0;
+        }
+
+        return columns;
+    }
+
+    columns = 1;
+
+    while (columns < count_points && points[columns].y == points[0].y) {
+        columns++;
+    }
+
+    if (columns < 2 || count_points % columns != 0 || count_points / columns < 2) {
+        return 0;
+    }
+
+    int rows = count_points / columns;
+
+    for (int c = 1; c < columns; c++) {
+        if (points[c].x <= points[c - 1].x) {
+            return 0;
+        }
+    }
+
+    for (int r = 1; r < rows; r++) {
+        config_point *row = &points[r * columns];
+
+        if (row[0].y <= row[-columns].y) {
+            return 0;
+        }
+
+        for (int c = 0; c < columns; c++) {
+            if (row[c].x != points[c].x || row[c].y != row[0].y) {
+                return 0;
+            }
+        }
+    }
+
+    return columns;
+}
+
+config_point_mapping* config_mesh_mapping(config_virtual_screen *config) {
+    return config->surface.count_points ? &config->surface : &config->monitor_position;
+}
+
+void config_mesh_points_build(config_display *display, config_virtual_screen *config, config_mesh_points *out, arena *arena) {
+    config_point_mapping *mapping = config_mesh_mapping(config);
+    int count_points = mapping->count_points;
+
+    float scale_x = 2.0f / (float) display->monitor_bounds.w;
+    float scale_y = 2.0f / (float) display->monitor_bounds.h;
+    float scale_u = 1.0f / (float) config->w;
+    float scale_v = 1.0f / (float) config->h;
+
+    out->count_points = count_points;
+    out->positions = (float*) config_mesh_alloc(arena, count_points * 2 * sizeof(float));
+    out->uvs = (float*) config_mesh_alloc(arena, count_points * 2 * sizeof(float));
+
+    for (int i = 0; i < count_points; i++) {
+        float x = (float) mapping->output_points[i].x;
+        float y = (float) mapping->output_points[i].y;
+
+        out->positions[i * 2] = (x * scale_x) - 1.0f;
+        out->positions[(i * 2) + 1] = 1.0f - (y * scale_y);
+
+        float u = (float) mapping->input_points[i].x * scale_u;
+        float v = (float) mapping->input_points[i].y * scale_v;
+
+        out->uvs[i * 2] = CLAMP(u, 0.0f, 1.0f);
+        out->uvs[(i * 2) + 1] = CLAMP(v, 0.0f, 1.0f);
+    }
+}
+
+void config_mesh_points_free(config_mesh_points *points) {
+    if (points->positions) {
+        free(points->positions);
+    }
+
+    if (points->uvs) {
+        free(points->uvs);
+    }
+
+    memset(points, 0, sizeof(config_mesh_points));
+}
+
+// Packs the normalized points of the mapping the triangles were built for
+static void config_mesh_build_triangles(config_mesh_points *points, config_mesh_triangles *triangles, config_mesh *out, arena *arena) {
+    int count_vertexes = points->count_points;
+    float min_x = 0.0f, min_y = 0.0f, max_x = 0.0f, max_y = 0.0f;
+
+    for (int i = 0; i < count_vertexes; i++) {
+        float x = points->positions[i * 2];
+        float y = points->positions[(i * 2) + 1];
+
+        if (i == 0 || x < min_x) min_x = x;
+        if (i == 0 || x > max_x) max_x = x;
+        if (i == 0 || y < min_y) min_y = y;
+        if (i == 0 || y > max_y) max_y = y;
+    }
+
+    float size_x = max_x > min_x ? max_x - min_x : 1.0f;
+    float size_y = max_y > min_y ? max_y - min_y : 1.0f;
+
+    out->position_bounds[0] = min_x;
+    out->position_bounds[1] = min_y;
+    out->position_bounds[2] = size_x;
+    out->position_bounds[3] = size_y;
+
+    out->count_vertexes = count_vertexes;
+    out->vertexes = (unsigned short*) config_mesh_alloc(arena, count_vertexes * 4 * sizeof(unsigned short));
+
+    for (int i = 0; i < count_vertexes; i++) {
+        float x = (points->positions[i * 2] - min_x) / size_x;
+        float y = (points->positions[(i * 2) + 1] - min_y) / size_y;
+
+        out->vertexes[i * 4] = CONFIG_MESH_UNORM16(x);
+        out->vertexes[(i * 4) + 1] = CONFIG_MESH_UNORM16(y);
+        out->vertexes[(i * 4) + 2] = CONFIG_MESH_UNORM16(points->uvs[i * 2]);
+        out->vertexes[(i * 4) + 3] = CONFIG_MESH_UNORM16(points->uvs[(i * 2) + 1]);
+    }
+
+    out->count_indexes = triangles->count_triangles * 3;
+    out->indexes = (unsigned int*) config_mesh_alloc(arena, out->count_indexes * sizeof(unsigned int));
+
+    memcpy(out->indexes, triangles->indexes, out->count_indexes * sizeof(unsigned int));
+
+    // Triangles may all be degenerate, e.g. every output point on one line
+    float area = 0.0f;
+
+    for (int i = 0; i < out->count_indexes && area == 0.0f; i += 3) {
+        float *a = &points->positions[out->indexes[i] * 2];
+        float *b = &points->positions[out->indexes[i + 1] * 2];
+        float *c = &points->positions[out->indexes[i + 2] * 2];
+
+        area = ((b[0] - a[0]) * (c[1] - a[1])) - ((b[1] - a[1]) * (c[0] - a[0]));
+    }
+
+    float visible_x0 = MAX(min_x, -1.0f);
+    float visible_y0 = MAX(min_y, -1.0f);
+    float visible_x1 = MIN(max_x, 1.0f);
+    float visible_y1 = MIN(max_y, 1.0f);
+
+    memset(out->visible_bounds, 0, sizeof(out->visible_bounds));
+
+    if (area != 0.0f && visible_x1 > visible_x0 && visible_y1 > visible_y0) {
+        out->visible_bounds[0] = visible_x0;
+        out->visible_bounds[1] = visible_y0;
+        out->visible_bounds[2] = visible_x1 - visible_x0;
+        out->visible_bounds[3] = visible_y1 - visible_y0;
+    }
+}
+
+void config_mesh_build(config_display *display, config_virtual_screen *config, config_mesh *out, arena *arena) {
+    config_virtual_screen built_config = *config;
+    config_mesh_points built_points;
+    config_mesh_points *points = &config->mesh_points;
+
+    // Not built by config_build_meshes, the surface may be missing too
+    if (points->positions == NULL) {
+        if (built_config.surface.count_points == 0) {
+            config_surface_build(&config->monitor_position, &built_config.surface, NULL);
+        }
+
+        config_mesh_points_build(display, &built_config, &built_points, NULL);
+        points = &built_points;
+    }
+
+    config_mesh_triangles *triangles = config_mesh_cache_acquire(config_mesh_mapping(&built_config));
+
+    config_mesh_build_triangles(points, triangles, out, arena);
+
+    config_mesh_cache_release(triangles);
+
+    if (points == &built_points) {
+        config_mesh_points_free(&built_points);
+
+        if (config->surface.count_points == 0) {
+            config_surface_free(&built_config.surface);
+        }
+    }
+}
+
+void config_mesh_free(config_mesh *mesh) {
+    if (mesh->vertexes) {
+        free(mesh->vertexes);
+    }
+
+    if (mesh->indexes) {
+        free(mesh->indexes);
+    }
+
+    memset(mesh, 0, sizeof(config_mesh));
+}
+
+typedef struct {
+    config_virtual_screen **virtual_screens;
+    config_mesh_triangles **triangles;
+} config_mesh_triangulate_work;
+
+static void config_mesh_triangulate_task(void *data, int begin, int end) {
+    config_mesh_triangulate_work *w = (config_mesh_triangulate_work*) data;
+
+    for (int i = begin; i < end; i++) {
+        w->triangles[i] = config_mesh_cache_acquire(config_mesh_mapping(w->virtual_screens[i]));
+    }
+}
+
+void config_build_meshes(projection_config *config) {
+    int count_virtual_screens = 0;
+
+    for (int i = 0; i < config->count_display; i++) {
+        count_virtual_screens += config->display[i].count_virtual_screen;
+    }
+
+    config_mesh_triangulate_work w;
+    w.virtual_screens = (config_virtual_screen**) malloc(count_virtual_screens * sizeof(config_virtual_screen*));
+    w.triangles = (config_mesh_triangles**) malloc(count_virtual_screens * sizeof(config_mesh_triangles*));
+
+    // Surfaces first, they are what bicubic virtual screens triangulate
+    for (int i = 0, k = 0; i < config->count_display; i++) {
+        config_display *display = &config->display[i];
+
+        for (int j = 0; j < display->count_virtual_screen; j++, k++) {
+            config_virtual_screen *vs = &display->virtual_screens[j];
+
+            config_surface_build(&vs->monitor_position, &vs->surface, config->arena);
+            w.virtual_screens[k] = vs;
+        }
+    }
+
+    // Acquire every virtual screen triangulation at once, in parallel. The
+    // arena is not thread safe, the meshes are packed from it below.
+    parallel_for(count_virtual_screens, 1, config_mesh_triangulate_task, &w);
+
+    for (int i = 0, k = 0; i < config->count_display; i++) {
+        config_display *display = &config->display[i];
+
+        for (int j = 0; j < display->count_virtual_screen; j++, k++) {
+            config_virtual_screen *vs = &display->virtual_screens[j];
+
+            config_mesh_points_build(display, vs, &vs->mesh_points, config->arena);
+            config_mesh_build_triangles(&vs->mesh_points, w.triangles[k], &vs->mesh, config->arena);
+
+            config_mesh_cache_release(w.triangles[k]);
+        }
+    }
+
+    free(w.virtual_screens);
+    free(w.triangles);
+}
@@ -0,0 +1,33 @@
+#include "config-structs.h"
+#include "arena.h"
+
+#ifndef _CONFIG_MESH_H_
+#define _CONFIG_MESH_H_
+
+// Points per row when the input points of the mapping are a row major grid,
+// declared by grid_columns or detected. 0 when not a grid.
+int config_mesh_grid_columns(config_point_mapping *mapping);
+
+// The mapping meshes are triangulated from: the tessellated surface of
+// bicubic mappings when built by config_build_meshes, the monitor position
+// otherwise
+config_point_mapping* config_mesh_mapping(config_virtual_screen *config);
+
+// Output arrays are allocated from arena, or the heap when NULL.
+// The *_free functions are for heap allocated ones only.
+
+// Normalizes the monitor position mapping of a virtual screen for the GPU
+void config_mesh_points_build(config_display *display, config_virtual_screen *config, config_mesh_points *out, arena *arena);
+void config_mesh_points_free(config_mesh_points *points);
+
+// Triangulates the monitor position mapping of a virtual screen, or its
+// bicubic surface, using its mesh points when already built. CPU only, safe
+// to call from any thread.
+void config_mesh_build(config_display *display, config_virtual_screen *config, config_mesh *out, arena *arena);
+void config_mesh_free(config_mesh *mesh);
+
+// Builds the surface, mesh points and mesh of every virtual screen, from the config arena.
+// Virtual screens are triangulated on worker threads.
+void config_build_meshes(projection_config *config);
+
+#endif
@@ -0,0 +1,149 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "custom-math.h"
+#include "parallel.h"
+#include "config-remap.h"
+
+// Keeps pixels centered on shared edges from falling between both triangles
+#define CONFIG_REMAP_EDGE_EPSILON 1e-6f
+
+typedef struct {
+    config_mesh *mesh;
+    config_remap *out;
+
+    // Vertex positions in remap pixels, u, v in 0..1
+    float *positions;
+    float *uvs;
+} config_remap_work;
+
+static float config_remap_edge(float ax, float ay, float bx, float by, float px, float py) {
+    return ((bx - ax) * (py - ay)) - ((by - ay) * (px - ax));
+}
+
+// Each range of rows walks every triangle, clipped to its rows. Pixels are
+// covered when their center is inside, or on an edge, of a triangle.
+static void config_remap_rasterize_task(void *data, int begin, int end) {
+    config_remap_work *w = (config_remap_work*) data;
+    config_remap *out = w->out;
+    unsigned int *indexes = w->mesh->indexes;
+
+    for (int t = 0; t < w->mesh->count_indexes; t += 3) {
+        unsigned int i0 = indexes[t], i1 = indexes[t + 1], i2 = indexes[t + 2];
+
+        float x0 = w->positions[i0 * 2], y0 = w->positions[(i0 * 2) + 1];
+        float x1 = w->positions[i1 * 2], y1 = w->positions[(i1 * 2) + 1];
+        float x2 = w->positions[i2 * 2], y2 = w->positions[(i2 * 2) + 1];
+
+        float area = config_remap_edge(x0, y0, x1, y1, x2, y2);
+
+        if (area == 0.0f) {
+            continue;
+        }
+
+        int row_begin = MAX((int) floorf(MIN(y0, MIN(y1, y2)) - 0.5f), begin);
+        int row_end = MIN((int) ceilf(MAX(y0, MAX(y1, y2)) - 0.5f) + 1, end);
+        int column_begin = MAX((int) floorf(MIN(x0, MIN(x1, x2)) - 0.5f), 0);
+        int column_end = MIN((int) ceilf(MAX(x0, MAX(x1, x2)) - 0.5f) + 1, out->w);
+
+        float inverse_area = 1.0f / area;
+
+        float u0 = w->uvs[i0 * 2], v0 = w->uvs[(i0 * 2) + 1];
+        float u1 = w->uvs[i1 * 2], v1 = w->uvs[(i1 * 2) + 1];
+        float u2 = w->uvs[i2 * 2], v2 = w->uvs[(i2 * 2) + 1];
+
+        for (int row = row_begin; row < row_end; row++) {
+            float py = row + 0.5f;
+            unsigned short *uvs = &out->uvs[(size_t) row * out->w * 2];
+
+            for (int column = column_begin; column < column_end; column++) {
+                float px = column + 0.5f;
+
+                // Barycentric weights, all of the area sign when inside
+                float b0 = config_remap_edge(x1, y1, x2, y2, px, py) * inverse_area;
+                float b1 = config_remap_edge(x2, y2, x0, y0, px, py) * inverse_area;
+                float b2 = 1.0f - b0 - b1;
+
+                if (b0 < -CONFIG_REMAP_EDGE_EPSILON || b1 < -CONFIG_REMAP_EDGE_EPSILON || b2 < -CONFIG_REMAP_EDGE_EPSILON) {
+                    continue;
+                }
+
+                float u = (b0 * u0) + (b1 * u1) + (b2 * u2);
+                float v = (b0 * v0) + (b1 * v1) + (b2 * v2);
+
+                uvs[column * 2] = (unsigned short) ((CLAMP(u, 0.0f, 1.0f) * CONFIG_REMAP_UV_MAX) + 0.5f);
+                uvs[(column * 2) + 1] = (unsigned short) ((CLAMP(v, 0.0f, 1.0f) * CONFIG_REMAP_UV_MAX) + 0.5f);
+            }
+        }
+    }
+}
+
+void config_remap_build(config_display *display, config_mesh *mesh, config_remap *out) {
+    memset(out, 0, sizeof(config_remap));
+
+    float display_w = (float) display->monitor_bounds.w;
+    float display_h = (float) display->monitor_bounds.h;
+    float *bounds = mesh->position_bounds;
+
+    if (mesh->count_indexes == 0 || display_w <= 0.0f || display_h <= 0.0f) {
+        return;
+    }
+
+    // Clip space bounds to pixels, clamped to the display
+    int x0 = CLAMP((int) floorf((bounds[0] + 1.0f) * 0.5f * display_w), 0, (int) display_w);
+    int y0 = CLAMP((int) floorf((bounds[1] + 1.0f) * 0.5f * display_h), 0, (int) display_h);
+    int x1 = CLAMP((int) ceilf((bounds[0] + bounds[2] + 1.0f) * 0.5f * display_w), 0, (int) display_w);
+    int y1 = CLAMP((int) ceilf((bounds[1] + bounds[3] + 1.0f) * 0.5f * display_h), 0, (int) display_h);
+
+    if (x1 <= x0 || y1 <= y0) {
+        return;
+    }
+
+    out->x = x0;
+    out->y = y0;
+    out->w = x1 - x0;
+    out->h = y1 - y0;
+
+    size_t count_pixels = (size_t) out->w * out->h;
+    out->uvs = (unsigned short*) malloc(count_pixels * 2 * sizeof(unsigned short));
+
+    for (size_t i = 0; i < count_pixels; i++) {
+        out->uvs[i * 2] = CONFIG_REMAP_EMPTY;
+        out->uvs[(i * 2) + 1] = 0;
+    }
+
+    config_remap_work w;
+
+    w.mesh = mesh;
+    w.out = out;
+    w.positions = (float*) malloc(mesh->count_vertexes * 2 * sizeof(float));
+    w.uvs = (float*) malloc(mesh->count_vertexes * 2 * sizeof(float));
+
+    float scale_x = bounds[2] * 0.5f * display_w / 65535.0f;
+    float scale_y = bounds[3] * 0.5f * display_h / 65535.0f;
+    float offset_x = ((bounds[0] + 1.0f) * 0.5f * display_w) - x0;
+    float offset_y = ((bounds[1] + 1.0f) * 0.5f * display_h) - y0;
+
+    for (int i = 0; i < mesh->count_vertexes; i++) {
+        unsigned short *vertex = &mesh->vertexes[i * 4];
+
+        w.positions[i * 2] = offset_x + (vertex[0] * scale_x);
+        w.positions[(i * 2) + 1] = offset_y + (vertex[1] * scale_y);
+        w.uvs[i * 2] = vertex[2] / 65535.0f;
+        w.uvs[(i * 2) + 1] = vertex[3] / 65535.0f;
+    }
+
+    parallel_for(out->h, 32, config_remap_rasterize_task, &w);
+
+    free(w.positions);
+    free(w.uvs);
+}
+
+void config_remap_free(config_remap *remap) {
+    if (remap->uvs) {
+        free(remap->uvs);
+    }
+
+    memset(remap, 0, sizeof(config_remap));
+}
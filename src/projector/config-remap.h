@@ -0,0 +1,26 @@
+#include "config-structs.h"
+
+#ifndef _CONFIG_REMAP_H_
+#define _CONFIG_REMAP_H_
+
+// Warp baked into a per output pixel lookup, an alternative to drawing the
+// mesh: each frame costs one texture fetch per pixel whatever the mesh size.
+// u, v are stored as unsigned shorts of 0..CONFIG_REMAP_UV_MAX,
+// a u of CONFIG_REMAP_EMPTY marks pixels no triangle covers.
+#define CONFIG_REMAP_UV_MAX 65534
+#define CONFIG_REMAP_EMPTY 65535
+
+typedef struct {
+    // Display pixels covered by the mesh, y from the bottom like GL textures
+    int x, y, w, h;
+
+    // u, v per pixel, w * h rows from the bottom
+    unsigned short *uvs;
+} config_remap;
+
+// Rasterizes the mesh at the display resolution on worker threads. CPU only,
+// safe to call from any thread.
+void config_remap_build(config_display *display, config_mesh *mesh, config_remap *out);
+void config_remap_free(config_remap *remap);
+
+#endif
@@ -48,6 +48,15 @@ cJSON* serialize_config_point_mapping(config_point_mapping *in) {
         cJSON_CreateNumber(in->output_vertical_adjust_factor)
     );
 
+    if (in->grid_columns) {
+        cJSON_AddItemToObject(config_point_mapping_json, "grid_columns", cJSON_CreateNumber(in->grid_columns));
+    }
+
+    if (in->interpolation != CONFIG_POINT_MAPPING_LINEAR) {
+        cJSON_AddItemToObject(config_point_mapping_json, "interpolation", cJSON_CreateNumber(in->interpolation));
+        cJSON_AddItemToObject(config_point_mapping_json, "surface_tolerance", cJSON_CreateNumber(in->surface_tolerance));
+    }
+
     return config_point_mapping_json;
 }
 
@@ -137,7 +146,7 @@ cJSON* serialize_config_black_level_adjust(config_black_level_adjust *in) {
     cJSON_AddItemToObject(config_black_level_adjust_json, "x1", cJSON_CreateNumber(in->x1));
     cJSON_AddItemToObject(config_black_level_adjust_json, "x2", cJSON_CreateNumber(in->x2));
     cJSON_AddItemToObject(config_black_level_adjust_json, "x3", cJSON_CreateNumber(in->x3));
-    cJSON_AddItemToObject(config_black_level_adjust_json, "x3", cJSON_CreateNumber(in->x4));
+    cJSON_AddItemToObject(config_black_level_adjust_json, "x4", cJSON_CreateNumber(in->x4));
 
     cJSON_AddItemToObject(config_black_level_adjust_json, "y1", cJSON_CreateNumber(in->y1));
     cJSON_AddItemToObject(config_black_level_adjust_json, "y2", cJSON_CreateNumber(in->y2));
@@ -164,6 +173,10 @@ cJSON* serialize_config_virtual_screen(config_virtual_screen *in) {
     
     cJSON_AddItemToObject(config_virtual_screen_json, "monitor_position", serialize_config_point_mapping(&in->monitor_position));
 
+    if (in->remap_warp) {
+        cJSON_AddItemToObject(config_virtual_screen_json, "remap_warp", cJSON_CreateNumber(in->remap_warp));
+    }
+
     cJSON *blends_json = cJSON_CreateArray();
     for (int i=0; i < in->count_blends; i++) {
         cJSON_AddItemToArray(blends_json, serialize_config_blend(&in->blends[i]));
@@ -0,0 +1,795 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <locale.h>
+
+#include "debug.h"
+#include "arena.h"
+#include "config-cache.h"
+#include "config-stream-parse.h"
+
+#define CONFIG_STREAM_KEY_LENGTH 64
+#define CONFIG_STREAM_NUMBER_LENGTH 64
+
+typedef struct {
+    FILE *file;
+    char buffer[CONFIG_STREAM_BUFFER_SIZE];
+    size_t position;
+    size_t length;
+    int eof;
+    int error;
+    unsigned long long hash;
+    arena *arena;
+} config_stream;
+
+// Tokenizer
+
+static int config_stream_refill(config_stream *s) {
+    if (s->eof) {
+        return 0;
+    }
+
+    s->position = 0;
+    s->length = fread(s->buffer, 1, sizeof(s->buffer), s->file);
+
+    if (s->length == 0) {
+        s->eof = 1;
+        return 0;
+    }
+
+    s->hash = config_cache_hash(s->hash, s->buffer, s->length);
+
+    return 1;
+}
+
+static inline int config_stream_peek(config_stream *s) {
+    if (s->position == s->length && !config_stream_refill(s)) {
+        return -1;
+    }
+
+    return (unsigned char) s->buffer[s->position];
+}
+
+static inline void config_stream_fail(config_stream *s, const char *reason) {
+    if (!s->error) {
+        log_debug("Config JSON parse error: %s\n", reason);
+    }
+
+    s->error = 1;
+}
+
+static void config_stream_skip_whitespace(config_stream *s) {
+    for (;;) {
+        int c = config_stream_peek(s);
+
+        if (c != ' ' && c != '\n' && c != '\r' && c != '\t') {
+            return;
+        }
+
+        s->position++;
+    }
+}
+
+// Skips whitespace, then consumes c if it is the next char
+static int config_stream_accept(config_stream *s, int c) {
+    config_stream_skip_whitespace(s);
+
+    if (config_stream_peek(s) == c) {
+        s->position++;
+        return 1;
+    }
+
+    return 0;
+}
+
+static void config_stream_expect(config_stream *s, int c, const char *reason) {
+    if (!config_stream_accept(s, c)) {
+        config_stream_fail(s, reason);
+    }
+}
+
+static int config_stream_peek_value(config_stream *s) {
+    config_stream_skip_whitespace(s);
+    return config_stream_peek(s);
+}
+
+// Reads a string, truncated to out_length - 1 chars. out may be NULL to skip it.
+static void config_stream_read_string(config_stream *s, char *out, size_t out_length) {
+    size_t length = 0;
+
+    if (!config_stream_accept(s, '"')) {
+        config_stream_fail(s, "string expected");
+        return;
+    }
+
+    for (;;) {
+        int c = config_stream_peek(s);
+
+        if (c < 0) {
+            config_stream_fail(s, "unterminated string");
+            break;
+        }
+
+        s->position++;
+
+        if (c == '"') {
+            break;
+        }
+
+        if (c == '\\') {
+            c = config_stream_peek(s);
+            s->position++;
+
+            switch (c) {
+                case 'b': c = '\b'; break;
+                case 'f': c = '\f'; break;
+                case 'n': c = '\n'; break;
+                case 'r': c = '\r'; break;
+                case 't': c = '\t'; break;
+                case 'u':
+                    // Keys are ASCII, anything else is only skipped
+                    for (int i = 0; i < 4; i++) {
+                        config_stream_peek(s);
+                        s->position++;
+                    }
+
+                    c = '?';
+                    break;
+                case -1:
+                    config_stream_fail(s, "unterminated string");
+                    return;
+            }
+        }
+
+        if (out && length + 1 < out_length) {
+            out[length++] = (char) c;
+        }
+    }
+
+    if (out) {
+        out[length] = 0;
+    }
+}
+
+static const double config_stream_powers_of_ten[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+    1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Locale independent strtod, like cJSON does
+static int config_stream_strtod(char *text, double *out) {
+    struct lconv *lconv = localeconv();
+    char decimal_point = lconv && lconv->decimal_point ? lconv->decimal_point[0] : '.';
+
+    for (char *c = text; *c; c++) {
+        if (*c == '.') {
+            *c = decimal_point;
+        }
+    }
+
+    char *end;
+    *out = strtod(text, &end);
+
+    return end != text && *end == 0;
+}
+
+static int config_stream_convert_number(char *text, double *out) {
+    const char *c = text;
+    int negative = 0;
+    unsigned long long mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    int truncated = 0;
+
+    if (*c == '-') {
+        negative = 1;
+        c++;
+    }
+
+    if (*c < '0' || *c > '9') {
+        return 0;
+    }
+
+    for (; *c >= '0' && *c <= '9'; c++) {
+        if (digits < 19) {
+            mantissa = (mantissa * 10) + (*c - '0');
+            digits += mantissa != 0;
+        } else {
+            exponent++;
+            truncated = 1;
+        }
+    }
+
+    if (*c == '.') {
+        for (c++; *c >= '0' && *c <= '9'; c++) {
+            if (digits < 19) {
+                mantissa = (mantissa * 10) + (*c - '0');
+                digits += mantissa != 0;
+                exponent--;
+            } else {
+                truncated = 1;
+            }
+        }
+    }
+
+    if (*c == 'e' || *c == 'E') {
+        truncated = 1;
+    }
+
+    // Exact when both the mantissa and the power of ten fit in a double
+    if (*c == 0 && !truncated && mantissa <= (1ULL << 53) && exponent >= -22 && exponent <= 22) {
+        double value = (double) mantissa;
+
+        if (exponent < 0) {
+            value /= config_stream_powers_of_ten[-exponent];
+        } else {
+            value *= config_stream_powers_of_ten[exponent];
+        }
+
+        *out = negative ? -value : value;
+
+        return 1;
+    }
+
+    return config_stream_strtod(text, out);
+}
+
+static int config_stream_is_number_char(int c) {
+    return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+static void config_stream_skip_literal(config_stream *s) {
+    int length = 0;
+
+    for (int c = config_stream_peek(s); (c >= 'a' && c <= 'z') || config_stream_is_number_char(c); c = config_stream_peek(s)) {
+        s->position++;
+        length++;
+    }
+
+    if (length == 0) {
+        config_stream_fail(s, "value expected");
+    }
+}
+
+static void config_stream_skip_value_depth(config_stream *s, int depth);
+
+// Object and array iteration. Both return 0 once the container is closed or
+// on errors, the caller just stops reading.
+
+static int config_stream_begin(config_stream *s, int open) {
+    if (config_stream_peek_value(s) != open) {
+        config_stream_skip_value_depth(s, 0);
+        return 0;
+    }
+
+    s->position++;
+
+    return 1;
+}
+
+static int config_stream_next_key(config_stream *s, int *first, char *key) {
+    if (s->error || config_stream_accept(s, '}')) {
+        return 0;
+    }
+
+    if (!*first) {
+        config_stream_expect(s, ',', "',' expected between object members");
+    }
+
+    *first = 0;
+
+    config_stream_read_string(s, key, CONFIG_STREAM_KEY_LENGTH);
+    config_stream_expect(s, ':', "':' expected after object key");
+
+    return !s->error;
+}
+
+static int config_stream_next_item(config_stream *s, int *first) {
+    if (s->error || config_stream_accept(s, ']')) {
+        return 0;
+    }
+
+    if (!*first) {
+        config_stream_expect(s, ',', "',' expected between array items");
+    }
+
+    *first = 0;
+
+    return !s->error;
+}
+
+static void config_stream_skip_value_depth(config_stream *s, int depth) {
+    char key[CONFIG_STREAM_KEY_LENGTH];
+    int first = 1;
+
+    if (depth > CONFIG_STREAM_MAX_DEPTH) {
+        config_stream_fail(s, "nested too deep");
+        return;
+    }
+
+    switch (config_stream_peek_value(s)) {
+        case '{':
+            s->position++;
+
+            while (config_stream_next_key(s, &first, key)) {
+                config_stream_skip_value_depth(s, depth + 1);
+            }
+            break;
+        case '[':
+            s->position++;
+
+            while (config_stream_next_item(s, &first)) {
+                config_stream_skip_value_depth(s, depth + 1);
+            }
+            break;
+        case '"':
+            config_stream_read_string(s, NULL, 0);
+            break;
+        default:
+            config_stream_skip_literal(s);
+    }
+}
+
+static void config_stream_skip_value(config_stream *s) {
+    config_stream_skip_value_depth(s, 0);
+}
+
+#define CONFIG_STREAM_OBJECT(s, key) \
+    char key[CONFIG_STREAM_KEY_LENGTH]; \
+    int key##_first = 1; \
+    if (config_stream_begin(s, '{')) \
+        while (config_stream_next_key(s, &key##_first, key))
+
+#define CONFIG_STREAM_ARRAY(s) \
+    int item_first = 1; \
+    if (config_stream_begin(s, '[')) \
+        while (config_stream_next_item(s, &item_first))
+
+// Non numbers read as 0, like cJSON valuedouble
+static double config_stream_read_number(config_stream *s) {
+    char text[CONFIG_STREAM_NUMBER_LENGTH];
+    int length = 0;
+    double value = 0.0;
+
+    int c = config_stream_peek_value(s);
+
+    if (!config_stream_is_number_char(c)) {
+        config_stream_skip_value(s);
+        return 0.0;
+    }
+
+    for (; config_stream_is_number_char(c); c = config_stream_peek(s)) {
+        if (length + 1 == CONFIG_STREAM_NUMBER_LENGTH) {
+            config_stream_fail(s, "number too long");
+            return 0.0;
+        }
+
+        text[length++] = (char) c;
+        s->position++;
+    }
+
+    text[length] = 0;
+
+    if (!config_stream_convert_number(text, &value)) {
+        config_stream_fail(s, "invalid number");
+    }
+
+    return value;
+}
+
+// For optional fields, only numbers override the default
+static double config_stream_read_number_or(config_stream *s, double fallback) {
+    if (!config_stream_is_number_char(config_stream_peek_value(s))) {
+        config_stream_skip_value(s);
+        return fallback;
+    }
+
+    return config_stream_read_number(s);
+}
+
+// Saturates like cJSON valueint
+static int config_stream_read_int(config_stream *s) {
+    double value = config_stream_read_number(s);
+
+    if (value >= INT32_MAX) {
+        return INT32_MAX;
+    }
+
+    if (value <= INT32_MIN) {
+        return INT32_MIN;
+    }
+
+    return (int) value;
+}
+
+// Appends a zeroed item to a growing array, returns it
+static void* config_stream_push(config_stream *s, void **items, int *count, int *capacity, size_t item_size) {
+    if (*count == *capacity) {
+        int new_capacity = *capacity ? *capacity * 2 : 4;
+
+        if (s->arena) {
+            *items = arena_grow(s->arena, *items, *capacity * item_size, new_capacity * item_size);
+        } else {
+            *items = realloc(*items, new_capacity * item_size);
+        }
+
+        *capacity = new_capacity;
+    }
+
+    char *item = ((char*) *items) + (*count * item_size);
+    memset(item, 0, item_size);
+
+    (*count)++;
+
+    return item;
+}
+
+// Config structs
+
+static void stream_parse_config_bounds(config_stream *s, config_bounds *out) {
+    CONFIG_STREAM_OBJECT(s, key) {
+        if (strcmp(key, "x") == 0) {
+            out->x = config_stream_read_number(s);
+        } else if (strcmp(key, "y") == 0) {
+            out->y = config_stream_read_number(s);
+        } else if (strcmp(key, "w") == 0) {
+            out->w = config_stream_read_number(s);
+        } else if (strcmp(key, "h") == 0) {
+            out->h = config_stream_read_number(s);
+        } else {
+            config_stream_skip_value(s);
+        }
+    }
+}
+
+static void stream_parse_config_points(config_stream *s, config_point **out, int *count) {
+    int capacity = 0;
+
+    *count = 0;
+
+    CONFIG_STREAM_ARRAY(s) {
+        config_point *point = (config_point*) config_stream_push(s, (void**) out, count, &capacity, sizeof(config_point));
+
+        CONFIG_STREAM_OBJECT(s, key) {
+            if (key[0] == 'x' && key[1] == 0) {
+                point->x = config_stream_read_number(s);
+            } else if (key[0] == 'y' && key[1] == 0) {
+                point->y = config_stream_read_number(s);
+            } else {
+                config_stream_skip_value(s);
+            }
+        }
+    }
+}
+
+static void stream_parse_config_point_mapping(config_stream *s, config_point_mapping *out) {
+    int count_input_points = 0;
+    int count_output_points = 0;
+
+    out->output_horizontal_adjust_factor = 1.0;
+    out->output_vertical_adjust_factor = 1.0;
+
+    CONFIG_STREAM_OBJECT(s, key) {
+        if (strcmp(key, "input_points") == 0) {
+            stream_parse_config_points(s, &out->input_points, &count_input_points);
+        } else if (strcmp(key, "output_points") == 0) {
+            stream_parse_config_points(s, &out->output_points, &count_output_points);
+        } else if (strcmp(key, "output_horizontal_adjust_factor") == 0) {
+            out->output_horizontal_adjust_factor = config_stream_read_number_or(s, 1.0);
+        } else if (strcmp(key, "output_vertical_adjust_factor") == 0) {
+            out->output_vertical_adjust_factor = config_stream_read_number_or(s, 1.0);
+        } else if (strcmp(key, "grid_columns") == 0) {
+            if (config_stream_is_number_char(config_stream_peek_value(s))) {
+                out->grid_columns = config_stream_read_int(s);
+            } else {
+                config_stream_skip_value(s);
+            }
+        } else if (strcmp(key, "interpolation") == 0) {
+            if (config_stream_is_number_char(config_stream_peek_value(s))) {
+                out->interpolation = config_stream_read_int(s);
+            } else {
+                config_stream_skip_value(s);
+            }
+        } else if (strcmp(key, "surface_tolerance") == 0) {
+            out->surface_tolerance = config_stream_read_number_or(s, 0.0);
+        } else {
+            config_stream_skip_value(s);
+        }
+    }
+
+    if (count_input_points != count_output_points) {
+        log_debug("Invalid point mapping. Input points: %i; Output points %i\n", count_input_points, count_output_points);
+    }
+
+    out->count_points = count_input_points < count_output_points ? count_input_points : count_output_points;
+}
+
+static void stream_parse_config_blend(config_stream *s, config_blend *out) {
+    out->curve_exponent = 2.0;
+
+    CONFIG_STREAM_OBJECT(s, key) {
+        if (strcmp(key, "position") == 0) {
+            stream_parse_config_bounds(s, &out->position);
+        } else if (strcmp(key, "direction") == 0) {
+            out->direction = config_stream_read_int(s);
+        } else if (strcmp(key, "curve_exponent") == 0) {
+            out->curve_exponent = config_stream_read_number_or(s, 2.0);
+        } else {
+            config_stream_skip_value(s);
+        }
+    }
+}
+
+static void stream_parse_config_help_line(config_stream *s, config_help_line *out) {
+    CONFIG_STREAM_OBJECT(s, key) {
+        if (strcmp(key, "x1") == 0) {
+            out->x1 = config_stream_read_int(s);
+        } else if (strcmp(key, "x2") == 0) {
+            out->x2 = config_stream_read_int(s);
+        } else if (strcmp(key, "y1") == 0) {
+            out->y1 = config_stream_read_int(s);
+        } else if (strcmp(key, "y2") == 0) {
+            out->y2 = config_stream_read_int(s);
+        } else if (strcmp(key, "line_width") == 0) {
+            out->line_width = config_stream_read_number(s);
+        } else {
+            config_stream_skip_value(s);
+        }
+    }
+}
+
+static void stream_parse_config_color_factor(config_stream *s, config_color_factor *out) {
+    out->a = 1.0;
+
+    CONFIG_STREAM_OBJECT(s, key) {
+        if (strcmp(key, "r") == 0) {
+            out->r = config_stream_read_number(s);
+        } else if (strcmp(key, "g") == 0) {
+            out->g = config_stream_read_number(s);
+        } else if (strcmp(key, "b") == 0) {
+            out->b = config_stream_read_number(s);
+        } else if (strcmp(key, "a") == 0) {
+            out->a = config_stream_read_number_or(s, 1.0);
+        } else {
+            config_stream_skip_value(s);
+        }
+    }
+}
+
+static void stream_parse_config_black_level_adjust(config_stream *s, config_black_level_adjust *out) {
+    out->color.a = 1.0;
+
+    CONFIG_STREAM_OBJECT(s, key) {
+        if (strcmp(key, "x1") == 0) {
+            out->x1 = config_stream_read_int(s);
+        } else if (strcmp(key, "x2") == 0) {
+            out->x2 = config_stream_read_int(s);
+        } else if (strcmp(key, "x3") == 0) {
+            out->x3 = config_stream_read_int(s);
+        } else if (strcmp(key, "x4") == 0) {
+            out->x4 = config_stream_read_int(s);
+        } else if (strcmp(key, "y1") == 0) {
+            out->y1 = config_stream_read_int(s);
+        } else if (strcmp(key, "y2") == 0) {
+            out->y2 = config_stream_read_int(s);
+        } else if (strcmp(key, "y3") == 0) {
+            out->y3 = config_stream_read_int(s);
+        } else if (strcmp(key, "y4") == 0) {
+            out->y4 = config_stream_read_int(s);
+        } else if (strcmp(key, "color") == 0) {
+            stream_parse_config_color_factor(s, &out->color);
+        } else {
+            config_stream_skip_value(s);
+        }
+    }
+}
+
+static void stream_default_config_color_matrix(config_color_matrix *out) {
+    memset(out, 0, sizeof(config_color_matrix));
+
+    out->r_to_r = 1.0;
+    out->r_exposure = 1.0;
+    out->g_to_g = 1.0;
+    out->g_exposure = 1.0;
+    out->b_to_b = 1.0;
+    out->b_exposure = 1.0;
+}
+
+static void stream_parse_config_color_matrix(config_stream *s, config_color_matrix *out) {
+    stream_default_config_color_matrix(out);
+
+    CONFIG_STREAM_OBJECT(s, key) {
+        double *field = NULL;
+
+        if (strcmp(key, "r_to_r") == 0) field = &out->r_to_r;
+        else if (strcmp(key, "r_to_g") == 0) field = &out->r_to_g;
+        else if (strcmp(key, "r_to_b") == 0) field = &out->r_to_b;
+        else if (strcmp(key, "r_exposure") == 0) field = &out->r_exposure;
+        else if (strcmp(key, "r_bright") == 0) field = &out->r_bright;
+        else if (strcmp(key, "g_to_r") == 0) field = &out->g_to_r;
+        else if (strcmp(key, "g_to_g") == 0) field = &out->g_to_g;
+        else if (strcmp(key, "g_to_b") == 0) field = &out->g_to_b;
+        else if (strcmp(key, "g_exposure") == 0) field = &out->g_exposure;
+        else if (strcmp(key, "g_bright") == 0) field = &out->g_bright;
+        else if (strcmp(key, "b_to_r") == 0) field = &out->b_to_r;
+        else if (strcmp(key, "b_to_g") == 0) field = &out->b_to_g;
+        else if (strcmp(key, "b_to_b") == 0) field = &out->b_to_b;
+        else if (strcmp(key, "b_exposure") == 0) field = &out->b_exposure;
+        else if (strcmp(key, "b_bright") == 0) field = &out->b_bright;
+
+        if (field) {
+            *field = config_stream_read_number_or(s, *field);
+        } else {
+            config_stream_skip_value(s);
+        }
+    }
+}
+
+static void stream_parse_config_color_corrector_single(config_stream *s, config_color_corrector *out) {
+    CONFIG_STREAM_OBJECT(s, key) {
+        double *field = NULL;
+
+        if (strcmp(key, "src_lum") == 0) field = &out->src_lum;
+        else if (strcmp(key, "src_q") == 0) field = &out->src_q;
+        else if (strcmp(key, "dst_hue") == 0) field = &out->dst_hue;
+        else if (strcmp(key, "dst_sat") == 0) field = &out->dst_sat;
+        else if (strcmp(key, "dst_lum") == 0) field = &out->dst_lum;
+
+        if (field) {
+            *field = config_stream_read_number_or(s, *field);
+        } else {
+            config_stream_skip_value(s);
+        }
+    }
+}
+
+static void stream_default_config_color_corrector(config_color_corrector *out) {
+    for (int i = 0; i < CONFIG_COLOR_CORRECTOR_LENGTH; i++) {
+        memset(&out[i], 0, sizeof(config_color_corrector));
+        out[i].src_q = 1.0;
+    }
+}
+
+// Either a single object or an array of up to CONFIG_COLOR_CORRECTOR_LENGTH
+static void stream_parse_config_color_corrector(config_stream *s, config_color_corrector *out) {
+    stream_default_config_color_corrector(out);
+
+    int c = config_stream_peek_value(s);
+
+    if (c == '{') {
+        stream_parse_config_color_corrector_single(s, out);
+        return;
+    }
+
+    int index = 0;
+
+    CONFIG_STREAM_ARRAY(s) {
+        if (index < CONFIG_COLOR_CORRECTOR_LENGTH) {
+            stream_parse_config_color_corrector_single(s, &out[index++]);
+        } else {
+            config_stream_skip_value(s);
+        }
+    }
+}
+
+static void stream_parse_config_virtual_screen(config_stream *s, config_virtual_screen *out) {
+    int capacity_blends = 0;
+    int capacity_help_lines = 0;
+    int capacity_black_level_adjusts = 0;
+
+    // Missing objects get the same defaults as present but empty ones
+    out->background_clear_color.a = 1.0;
+    stream_default_config_color_matrix(&out->color_matrix);
+    stream_default_config_color_corrector(out->color_corrector);
+
+    CONFIG_STREAM_OBJECT(s, key) {
+        if (strcmp(key, "w") == 0) {
+            out->w = config_stream_read_int(s);
+        } else if (strcmp(key, "h") == 0) {
+            out->h = config_stream_read_int(s);
+        } else if (strcmp(key, "background_clear_color") == 0) {
+            stream_parse_config_color_factor(s, &out->background_clear_color);
+        } else if (strcmp(key, "render_input_bounds") == 0) {
+            stream_parse_config_bounds(s, &out->render_input_bounds);
+        } else if (strcmp(key, "color_matrix") == 0) {
+            stream_parse_config_color_matrix(s, &out->color_matrix);
+        } else if (strcmp(key, "color_corrector") == 0) {
+            stream_parse_config_color_corrector(s, out->color_corrector);
+        } else if (strcmp(key, "monitor_position") == 0) {
+            stream_parse_config_point_mapping(s, &out->monitor_position);
+        } else if (strcmp(key, "remap_warp") == 0) {
+            if (config_stream_is_number_char(config_stream_peek_value(s))) {
+                out->remap_warp = config_stream_read_int(s);
+            } else {
+                config_stream_skip_value(s);
+            }
+        } else if (strcmp(key, "blends") == 0) {
+            CONFIG_STREAM_ARRAY(s) {
+                stream_parse_config_blend(s, (config_blend*) config_stream_push(
+                    s, (void**) &out->blends, &out->count_blends, &capacity_blends, sizeof(config_blend)));
+            }
+        } else if (strcmp(key, "help_lines") == 0) {
+            CONFIG_STREAM_ARRAY(s) {
+                stream_parse_config_help_line(s, (config_help_line*) config_stream_push(
+                    s, (void**) &out->help_lines, &out->count_help_lines, &capacity_help_lines, sizeof(config_help_line)));
+            }
+        } else if (strcmp(key, "black_level_adjusts") == 0) {
+            CONFIG_STREAM_ARRAY(s) {
+                stream_parse_config_black_level_adjust(s, (config_black_level_adjust*) config_stream_push(
+                    s, (void**) &out->black_level_adjusts, &out->count_black_level_adjusts, &capacity_black_level_adjusts, sizeof(config_black_level_adjust)));
+            }
+        } else {
+            config_stream_skip_value(s);
+        }
+    }
+}
+
+static void stream_parse_config_display(config_stream *s, config_display *out) {
+    int capacity = 0;
+
+    CONFIG_STREAM_OBJECT(s, key) {
+        if (strcmp(key, "monitor_bounds") == 0) {
+            stream_parse_config_bounds(s, &out->monitor_bounds);
+        } else if (strcmp(key, "projection_enabled") == 0) {
+            out->projection_enabled = config_stream_read_int(s);
+        } else if (strcmp(key, "virtual_screens") == 0) {
+            CONFIG_STREAM_ARRAY(s) {
+                stream_parse_config_virtual_screen(s, (config_virtual_screen*) config_stream_push(
+                    s, (void**) &out->virtual_screens, &out->count_virtual_screen, &capacity, sizeof(config_virtual_screen)));
+            }
+        } else {
+            config_stream_skip_value(s);
+        }
+    }
+}
+
+int stream_parse_projection_config(FILE *file, projection_config *out, unsigned long long *hash) {
+    config_stream *s = (config_stream*) malloc(sizeof(config_stream));
+    int capacity = 0;
+
+    s->file = file;
+    s->position = 0;
+    s->length = 0;
+    s->eof = 0;
+    s->error = 0;
+    s->hash = CONFIG_CACHE_HASH_SEED;
+    s->arena = out->arena;
+
+    if (config_stream_peek_value(s) != '{') {
+        config_stream_fail(s, "config must be an object");
+    }
+
+    CONFIG_STREAM_OBJECT(s, key) {
+        if (strcmp(key, "display") == 0) {
+            CONFIG_STREAM_ARRAY(s) {
+                stream_parse_config_display(s, (config_display*) config_stream_push(
+                    s, (void**) &out->display, &out->count_display, &capacity, sizeof(config_display)));
+            }
+        } else {
+            config_stream_skip_value(s);
+        }
+    }
+
+    // Trailing whitespace only
+    if (!s->error && config_stream_peek_value(s) != -1) {
+        config_stream_fail(s, "unexpected data after config");
+    }
+
+    if (hash) {
+        while (config_stream_refill(s));
+        *hash = s->hash;
+    }
+
+    if (ferror(file)) {
+        config_stream_fail(s, "read error");
+    }
+
+    log_debug("Count display: %i\n", out->count_display);
+
+    int success = !s->error;
+
+    free(s);
+
+    return success;
+}
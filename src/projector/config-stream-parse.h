@@ -0,0 +1,21 @@
+#include <stdio.h>
+
+#include "config-structs.h"
+
+#ifndef _CONFIG_STREAM_PARSE_H_
+#define _CONFIG_STREAM_PARSE_H_
+
+// Pull parser filling the config structs straight from the file, a chunk at a
+// time. No JSON tree is built and the file size is not limited.
+// Produces the same config as the cJSON parse_projection_config, kept in
+// bench/config-parse.c as the baseline of bench-config-parse.
+#define CONFIG_STREAM_BUFFER_SIZE (64 * 1024)
+#define CONFIG_STREAM_MAX_DEPTH 64
+
+// Arrays are allocated from out->arena, or the heap when NULL.
+// Returns 0 on malformed JSON. out may be partially filled then, free it with
+// free_projection_config. If hash is not NULL it receives config_cache_hash
+// of the whole file, seeded with CONFIG_CACHE_HASH_SEED.
+int stream_parse_projection_config(FILE *file, projection_config *out, unsigned long long *hash);
+
+#endif
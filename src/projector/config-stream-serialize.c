@@ -0,0 +1,442 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <locale.h>
+
+#include "config-stream-serialize.h"
+
+#define CONFIG_WRITER_MAX_DEPTH 16
+#define CONFIG_WRITER_NUMBER_LENGTH 32
+#define CONFIG_WRITER_MAX_DECIMALS 9
+
+typedef struct {
+    FILE *file;
+    char buffer[CONFIG_STREAM_SERIALIZE_BUFFER_SIZE];
+    size_t length;
+    int pretty;
+    int depth;
+    int first[CONFIG_WRITER_MAX_DEPTH];
+    int error;
+} config_writer;
+
+// Output
+
+static void config_writer_flush(config_writer *w) {
+    if (w->length > 0 && fwrite(w->buffer, 1, w->length, w->file) != w->length) {
+        w->error = 1;
+    }
+
+    w->length = 0;
+}
+
+static inline void config_writer_put(config_writer *w, const char *data, size_t size) {
+    if (w->length + size > sizeof(w->buffer)) {
+        config_writer_flush(w);
+    }
+
+    memcpy(w->buffer + w->length, data, size);
+    w->length += size;
+}
+
+static inline void config_writer_put_char(config_writer *w, char c) {
+    if (w->length == sizeof(w->buffer)) {
+        config_writer_flush(w);
+    }
+
+    w->buffer[w->length++] = c;
+}
+
+static void config_writer_indent(config_writer *w, int depth) {
+    config_writer_put_char(w, '\n');
+
+    for (int i = 0; i < depth; i++) {
+        config_writer_put_char(w, '\t');
+    }
+}
+
+// Numbers
+
+static const double config_writer_powers_of_ten[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9
+};
+
+static size_t config_writer_format_digits(unsigned long long value, int decimals, char *out) {
+    char digits[CONFIG_WRITER_NUMBER_LENGTH];
+    int count = 0;
+
+    do {
+        digits[count++] = '0' + (value % 10);
+        value /= 10;
+    } while (value > 0 || count <= decimals);
+
+    size_t length = 0;
+
+    while (count > 0) {
+        if (count == decimals) {
+            out[length++] = '.';
+        }
+
+        out[length++] = digits[--count];
+    }
+
+    return length;
+}
+
+// Locale independent, like cJSON does
+static size_t config_writer_format_printf(double value, char *out) {
+    struct lconv *lconv = localeconv();
+    char decimal_point = lconv && lconv->decimal_point ? lconv->decimal_point[0] : '.';
+    double test;
+
+    int length = snprintf(out, CONFIG_WRITER_NUMBER_LENGTH, "%1.15g", value);
+
+    if (sscanf(out, "%lg", &test) != 1 || test != value) {
+        length = snprintf(out, CONFIG_WRITER_NUMBER_LENGTH, "%1.17g", value);
+    }
+
+    for (int i = 0; i < length; i++) {
+        if (out[i] == decimal_point) {
+            out[i] = '.';
+        }
+    }
+
+    return length;
+}
+
+// Shortest fixed point text with up to 9 decimals that divides back to the
+// same double, which is what the parser fast path computes. Calibration
+// points are mostly like that, everything else goes through printf.
+static size_t config_writer_format_number(double value, char *out) {
+    if (isnan(value) || isinf(value)) {
+        memcpy(out, "null", 4);
+        return 4;
+    }
+
+    size_t length = 0;
+    double magnitude = fabs(value);
+
+    if (magnitude < 9007199254740992.0) {
+        for (int decimals = 0; decimals <= CONFIG_WRITER_MAX_DECIMALS; decimals++) {
+            double scaled = magnitude * config_writer_powers_of_ten[decimals];
+
+            if (scaled >= 9007199254740992.0) {
+                break;
+            }
+
+            unsigned long long mantissa = (unsigned long long) llround(scaled);
+
+            if ((double) mantissa / config_writer_powers_of_ten[decimals] == magnitude) {
+                if (signbit(value) && mantissa != 0) {
+                    out[length++] = '-';
+                }
+
+                return length + config_writer_format_digits(mantissa, decimals, out + length);
+            }
+        }
+    }
+
+    return config_writer_format_printf(value, out);
+}
+
+// Structure
+
+static void config_writer_begin(config_writer *w, char c) {
+    config_writer_put_char(w, c);
+
+    w->depth++;
+    w->first[w->depth] = 1;
+}
+
+static void config_writer_end_object(config_writer *w) {
+    if (w->pretty) {
+        config_writer_indent(w, w->depth - 1);
+    }
+
+    config_writer_put_char(w, '}');
+    w->depth--;
+}
+
+static void config_writer_end_array(config_writer *w) {
+    config_writer_put_char(w, ']');
+    w->depth--;
+}
+
+static void config_writer_key(config_writer *w, const char *key) {
+    if (!w->first[w->depth]) {
+        config_writer_put_char(w, ',');
+    }
+
+    w->first[w->depth] = 0;
+
+    if (w->pretty) {
+        config_writer_indent(w, w->depth);
+    }
+
+    config_writer_put_char(w, '"');
+    config_writer_put(w, key, strlen(key));
+    config_writer_put(w, w->pretty ? "\":\t" : "\":", w->pretty ? 3 : 2);
+}
+
+static void config_writer_item(config_writer *w) {
+    if (!w->first[w->depth]) {
+        config_writer_put(w, ", ", w->pretty ? 2 : 1);
+    }
+
+    w->first[w->depth] = 0;
+}
+
+static void config_writer_number(config_writer *w, double value) {
+    char text[CONFIG_WRITER_NUMBER_LENGTH];
+    config_writer_put(w, text, config_writer_format_number(value, text));
+}
+
+static void config_writer_number_field(config_writer *w, const char *key, double value) {
+    config_writer_key(w, key);
+    config_writer_number(w, value);
+}
+
+// Config structs, same layout as config-serialize.c
+
+static void stream_serialize_config_bounds(config_writer *w, config_bounds *in) {
+    config_writer_begin(w, '{');
+    config_writer_number_field(w, "x", in->x);
+    config_writer_number_field(w, "y", in->y);
+    config_writer_number_field(w, "w", in->w);
+    config_writer_number_field(w, "h", in->h);
+    config_writer_end_object(w);
+}
+
+static void stream_serialize_config_points(config_writer *w, config_point *in, int count) {
+    config_writer_begin(w, '[');
+
+    for (int i = 0; i < count; i++) {
+        config_writer_item(w);
+        config_writer_begin(w, '{');
+        config_writer_number_field(w, "x", in[i].x);
+        config_writer_number_field(w, "y", in[i].y);
+        config_writer_end_object(w);
+    }
+
+    config_writer_end_array(w);
+}
+
+static void stream_serialize_config_point_mapping(config_writer *w, config_point_mapping *in) {
+    config_writer_begin(w, '{');
+
+    config_writer_key(w, "input_points");
+    stream_serialize_config_points(w, in->input_points, in->count_points);
+
+    config_writer_key(w, "output_points");
+    stream_serialize_config_points(w, in->output_points, in->count_points);
+
+    config_writer_number_field(w, "output_horizontal_adjust_factor", in->output_horizontal_adjust_factor);
+    config_writer_number_field(w, "output_vertical_adjust_factor", in->output_vertical_adjust_factor);
+
+    if (in->grid_columns) {
+        config_writer_number_field(w, "grid_columns", in->grid_columns);
+    }
+
+    if (in->interpolation != CONFIG_POINT_MAPPING_LINEAR) {
+        config_writer_number_field(w, "interpolation", in->interpolation);
+        config_writer_number_field(w, "surface_tolerance", in->surface_tolerance);
+    }
+
+    config_writer_end_object(w);
+}
+
+static void stream_serialize_config_blend(config_writer *w, config_blend *in) {
+    config_writer_begin(w, '{');
+
+    config_writer_key(w, "position");
+    stream_serialize_config_bounds(w, &in->position);
+
+    config_writer_number_field(w, "direction", in->direction);
+    config_writer_number_field(w, "curve_exponent", in->curve_exponent);
+
+    config_writer_end_object(w);
+}
+
+static void stream_serialize_config_help_line(config_writer *w, config_help_line *in) {
+    config_writer_begin(w, '{');
+    config_writer_number_field(w, "x1", in->x1);
+    config_writer_number_field(w, "y1", in->y1);
+    config_writer_number_field(w, "x2", in->x2);
+    config_writer_number_field(w, "y2", in->y2);
+    config_writer_number_field(w, "line_width", in->line_width);
+    config_writer_end_object(w);
+}
+
+static void stream_serialize_config_color_factor(config_writer *w, config_color_factor *in) {
+    config_writer_begin(w, '{');
+    config_writer_number_field(w, "r", in->r);
+    config_writer_number_field(w, "g", in->g);
+    config_writer_number_field(w, "b", in->b);
+    config_writer_number_field(w, "a", in->a);
+    config_writer_end_object(w);
+}
+
+static void stream_serialize_config_color_matrix(config_writer *w, config_color_matrix *in) {
+    config_writer_begin(w, '{');
+
+    config_writer_number_field(w, "r_to_r", in->r_to_r);
+    config_writer_number_field(w, "r_to_g", in->r_to_g);
+    config_writer_number_field(w, "r_to_b", in->r_to_b);
+    config_writer_number_field(w, "r_exposure", in->r_exposure);
+    config_writer_number_field(w, "r_bright", in->r_bright);
+
+    config_writer_number_field(w, "g_to_r", in->g_to_r);
+    config_writer_number_field(w, "g_to_g", in->g_to_g);
+    config_writer_number_field(w, "g_to_b", in->g_to_b);
+    config_writer_number_field(w, "g_exposure", in->g_exposure);
+    config_writer_number_field(w, "g_bright", in->g_bright);
+
+    config_writer_number_field(w, "b_to_r", in->b_to_r);
+    config_writer_number_field(w, "b_to_g", in->b_to_g);
+    config_writer_number_field(w, "b_to_b", in->b_to_b);
+    config_writer_number_field(w, "b_exposure", in->b_exposure);
+    config_writer_number_field(w, "b_bright", in->b_bright);
+
+    config_writer_end_object(w);
+}
+
+static void stream_serialize_config_color_corrector(config_writer *w, config_color_corrector *in) {
+    config_writer_begin(w, '[');
+
+    for (int i = 0; i < CONFIG_COLOR_CORRECTOR_LENGTH; i++) {
+        config_writer_item(w);
+        config_writer_begin(w, '{');
+        config_writer_number_field(w, "src_lum", in[i].src_lum);
+        config_writer_number_field(w, "src_q", in[i].src_q);
+        config_writer_number_field(w, "dst_hue", in[i].dst_hue);
+        config_writer_number_field(w, "dst_sat", in[i].dst_sat);
+        config_writer_number_field(w, "dst_lum", in[i].dst_lum);
+        config_writer_end_object(w);
+    }
+
+    config_writer_end_array(w);
+}
+
+static void stream_serialize_config_black_level_adjust(config_writer *w, config_black_level_adjust *in) {
+    config_writer_begin(w, '{');
+
+    config_writer_number_field(w, "x1", in->x1);
+    config_writer_number_field(w, "x2", in->x2);
+    config_writer_number_field(w, "x3", in->x3);
+    config_writer_number_field(w, "x4", in->x4);
+
+    config_writer_number_field(w, "y1", in->y1);
+    config_writer_number_field(w, "y2", in->y2);
+    config_writer_number_field(w, "y3", in->y3);
+    config_writer_number_field(w, "y4", in->y4);
+
+    config_writer_key(w, "color");
+    stream_serialize_config_color_factor(w, &in->color);
+
+    config_writer_end_object(w);
+}
+
+static void stream_serialize_config_virtual_screen(config_writer *w, config_virtual_screen *in) {
+    config_writer_begin(w, '{');
+
+    config_writer_number_field(w, "w", in->w);
+    config_writer_number_field(w, "h", in->h);
+
+    config_writer_key(w, "background_clear_color");
+    stream_serialize_config_color_factor(w, &in->background_clear_color);
+
+    config_writer_key(w, "render_input_bounds");
+    stream_serialize_config_bounds(w, &in->render_input_bounds);
+
+    config_writer_key(w, "color_matrix");
+    stream_serialize_config_color_matrix(w, &in->color_matrix);
+
+    config_writer_key(w, "color_corrector");
+    stream_serialize_config_color_corrector(w, in->color_corrector);
+
+    config_writer_key(w, "monitor_position");
+    stream_serialize_config_point_mapping(w, &in->monitor_position);
+
+    if (in->remap_warp) {
+        config_writer_number_field(w, "remap_warp", in->remap_warp);
+    }
+
+    config_writer_key(w, "blends");
+    config_writer_begin(w, '[');
+    for (int i = 0; i < in->count_blends; i++) {
+        config_writer_item(w);
+        stream_serialize_config_blend(w, &in->blends[i]);
+    }
+    config_writer_end_array(w);
+
+    config_writer_key(w, "help_lines");
+    config_writer_begin(w, '[');
+    for (int i = 0; i < in->count_help_lines; i++) {
+        config_writer_item(w);
+        stream_serialize_config_help_line(w, &in->help_lines[i]);
+    }
+    config_writer_end_array(w);
+
+    config_writer_key(w, "black_level_adjusts");
+    config_writer_begin(w, '[');
+    for (int i = 0; i < in->count_black_level_adjusts; i++) {
+        config_writer_item(w);
+        stream_serialize_config_black_level_adjust(w, &in->black_level_adjusts[i]);
+    }
+    config_writer_end_array(w);
+
+    config_writer_end_object(w);
+}
+
+static void stream_serialize_config_display(config_writer *w, config_display *in) {
+    config_writer_begin(w, '{');
+
+    config_writer_key(w, "monitor_bounds");
+    stream_serialize_config_bounds(w, &in->monitor_bounds);
+
+    config_writer_number_field(w, "projection_enabled", in->projection_enabled);
+
+    config_writer_key(w, "virtual_screens");
+    config_writer_begin(w, '[');
+    for (int i = 0; i < in->count_virtual_screen; i++) {
+        config_writer_item(w);
+        stream_serialize_config_virtual_screen(w, &in->virtual_screens[i]);
+    }
+    config_writer_end_array(w);
+
+    config_writer_end_object(w);
+}
+
+int stream_serialize_projection_config(FILE *file, projection_config *in, int pretty) {
+    config_writer *w = (config_writer*) malloc(sizeof(config_writer));
+
+    w->file = file;
+    w->length = 0;
+    w->pretty = pretty;
+    w->depth = 0;
+    w->error = 0;
+
+    config_writer_begin(w, '{');
+
+    config_writer_key(w, "display");
+    config_writer_begin(w, '[');
+    for (int i = 0; i < in->count_display; i++) {
+        config_writer_item(w);
+        stream_serialize_config_display(w, &in->display[i]);
+    }
+    config_writer_end_array(w);
+
+    config_writer_end_object(w);
+
+    if (pretty) {
+        config_writer_put_char(w, '\n');
+    }
+
+    config_writer_flush(w);
+
+    int success = !w->error;
+
+    free(w);
+
+    return success;
+}
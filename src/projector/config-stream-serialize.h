@@ -0,0 +1,17 @@
+#include <stdio.h>
+
+#include "config-structs.h"
+
+#ifndef _CONFIG_STREAM_SERIALIZE_H_
+#define _CONFIG_STREAM_SERIALIZE_H_
+
+// Writes the config JSON straight to the file through a fixed buffer, no JSON
+// tree is built. Output is read back by stream_parse_projection_config to the
+// same values.
+#define CONFIG_STREAM_SERIALIZE_BUFFER_SIZE (64 * 1024)
+
+// Pretty output is indented with tabs like cJSON_Print, compact has no whitespace.
+// Returns 0 if writing failed.
+int stream_serialize_projection_config(FILE *file, projection_config *in, int pretty);
+
+#endif
@@ -5,6 +5,9 @@ typedef struct {
     double x, y;
 } config_point;
 
+#define CONFIG_POINT_MAPPING_LINEAR 0
+#define CONFIG_POINT_MAPPING_BICUBIC 1
+
 typedef struct {
     config_point *input_points;
     config_point *output_points;
@@ -13,12 +16,53 @@ typedef struct {
     double output_vertical_adjust_factor;
 
     int count_points;
+
+    // Points per row when the points are a row major grid, 0 to detect it
+    int grid_columns;
+
+    // CONFIG_POINT_MAPPING_*. Bicubic grids warp along a Catmull-Rom surface
+    // through the output points instead of straight lines between them.
+    int interpolation;
+
+    // Max distance in output pixels between the bicubic surface and its mesh, 0 for the default
+    double surface_tolerance;
 } config_point_mapping;
 
 typedef struct {
     double x, y, w, h;
 } config_bounds;
 
+// Point mapping as separate float arrays, already normalized for the GPU
+typedef struct {
+    int count_points;
+
+    // x, y per point, output points in display clip space
+    float *positions;
+
+    // u, v per point, input points normalized by the virtual screen size
+    float *uvs;
+} config_mesh_points;
+
+// Triangulated point mapping, indexed over the mapping points, ready to upload
+typedef struct {
+    int count_vertexes;
+    int count_indexes;
+
+    // Bounding box of the positions in display clip space: x, y, w, h
+    float position_bounds[4];
+
+    // Part of the bounding box on the display, in clip space: x, y, w, h.
+    // w and h are 0 when the mesh is off the display or covers no area.
+    float visible_bounds[4];
+
+    // x, y, u, v per vertex as normalized unsigned shorts.
+    // x, y are relative to position_bounds, u, v to the virtual screen size.
+    unsigned short *vertexes;
+
+    // 3 vertex indexes per triangle
+    unsigned int *indexes;
+} config_mesh;
+
 typedef struct {
     config_bounds position;
     int direction;
@@ -65,6 +109,16 @@ typedef struct {
 
     config_point_mapping monitor_position;
 
+    // Draw through a per pixel remap texture baked from the mesh instead of the mesh
+    int remap_warp;
+
+    // Derived from monitor_position, not part of the JSON file
+    // Bicubic monitor position tessellated into a dense linear grid, no points when linear
+    config_point_mapping surface;
+
+    config_mesh_points mesh_points;
+    config_mesh mesh;
+
     int count_blends;
     config_blend *blends;
 
@@ -86,6 +140,13 @@ typedef struct {
 typedef struct {
     int count_display;
     config_display *display;
+
+    // Compiled config cache mapping this config lives in, NULL when heap allocated
+    void *cache_mapping;
+
+    // Owns the config data (unless cache mapped) and per reload objects derived
+    // from it, freed with the config. NULL when heap allocated.
+    struct arena *arena;
 } projection_config;
 
 #endif
@@ -0,0 +1,269 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "custom-math.h"
+#include "debug.h"
+#include "parallel.h"
+#include "config-mesh.h"
+#include "config-surface.h"
+
+typedef struct {
+    config_point_mapping *mapping;
+    int rows, columns;
+    double tolerance;
+
+    // Subdivisions each control cell needs, row major
+    int *cell_subdivisions;
+
+    // Control cell and offset inside it of each output row and column
+    int *row_cells, *column_cells;
+    double *row_offsets, *column_offsets;
+    int count_rows, count_columns;
+
+    config_point *input_points;
+    config_point *output_points;
+} config_surface_work;
+
+static void* config_surface_alloc(arena *arena, size_t size) {
+    return arena ? arena_alloc(arena, size) : malloc(size);
+}
+
+// Control points past the grid borders are extrapolated linearly,
+// so the surface does not bend back at the edges
+static config_point config_surface_control(config_surface_work *w, int r, int c) {
+    config_point *points = w->mapping->output_points;
+
+    int r0 = CLAMP(r, 0, w->rows - 1);
+    int c0 = CLAMP(c, 0, w->columns - 1);
+
+    config_point p = points[(r0 * w->columns) + c0];
+
+    if (r != r0) {
+        config_point *inner = &points[((r < 0 ? 1 : w->rows - 2) * w->columns) + c0];
+        p.x += p.x - inner->x;
+        p.y += p.y - inner->y;
+    }
+
+    if (c != c0) {
+        config_point *inner = &points[(r0 * w->columns) + (c < 0 ? 1 : w->columns - 2)];
+        p.x += points[(r0 * w->columns) + c0].x - inner->x;
+        p.y += points[(r0 * w->columns) + c0].y - inner->y;
+    }
+
+    return p;
+}
+
+static double config_surface_catmull_rom(double p0, double p1, double p2, double p3, double t) {
+    return 0.5 * (
+        (2.0 * p1) +
+        ((p2 - p0) * t) +
+        (((2.0 * p0) - (5.0 * p1) + (4.0 * p2) - p3) * t * t) +
+        (((3.0 * p1) - p0 - (3.0 * p2) + p3) * t * t * t));
+}
+
+// Surface point in cell (r, c), s down the rows and t along the columns
+static config_point config_surface_eval(config_surface_work *w, int r, int c, double s, double t) {
+    double x[4], y[4];
+
+    for (int i = 0; i < 4; i++) {
+        config_point p0 = config_surface_control(w, r + i - 1, c - 1);
+        config_point p1 = config_surface_control(w, r + i - 1, c);
+        config_point p2 = config_surface_control(w, r + i - 1, c + 1);
+        config_point p3 = config_surface_control(w, r + i - 1, c + 2);
+
+        x[i] = config_surface_catmull_rom(p0.x, p1.x, p2.x, p3.x, t);
+        y[i] = config_surface_catmull_rom(p0.y, p1.y, p2.y, p3.y, t);
+    }
+
+    config_point out;
+    out.x = config_surface_catmull_rom(x[0], x[1], x[2], x[3], s);
+    out.y = config_surface_catmull_rom(y[0], y[1], y[2], y[3], s);
+
+    return out;
+}
+
+static config_point config_surface_bilinear(config_point *points, int columns, int r, int c, double s, double t) {
+    config_point *p00 = &points[(r * columns) + c];
+    config_point *p01 = p00 + 1;
+    config_point *p10 = p00 + columns;
+    config_point *p11 = p10 + 1;
+
+    config_point out;
+    out.x = (((p00->x * (1.0 - t)) + (p01->x * t)) * (1.0 - s)) + (((p10->x * (1.0 - t)) + (p11->x * t)) * s);
+    out.y = (((p00->y * (1.0 - t)) + (p01->y * t)) * (1.0 - s)) + (((p10->y * (1.0 - t)) + (p11->y * t)) * s);
+
+    return out;
+}
+
+// Linear pieces deviate from a smooth curve by about 1 / n^2 of the
+// single piece error when split n times. Measured at the cell center
+// and edge midpoints.
+static void config_surface_estimate_task(void *data, int begin, int end) {
+    config_surface_work *w = (config_surface_work*) data;
+    const double samples[5][2] = { { 0.5, 0.5 }, { 0.0, 0.5 }, { 1.0, 0.5 }, { 0.5, 0.0 }, { 0.5, 1.0 } };
+
+    for (int r = begin; r < end; r++) {
+        for (int c = 0; c < w->columns - 1; c++) {
+            double error = 0.0;
+
+            for (int i = 0; i < 5; i++) {
+                config_point smooth = config_surface_eval(w, r, c, samples[i][0], samples[i][1]);
+                config_point flat = config_surface_bilinear(w->mapping->output_points, w->columns, r, c, samples[i][0], samples[i][1]);
+
+                double distance = sqrt(((smooth.x - flat.x) * (smooth.x - flat.x)) + ((smooth.y - flat.y) * (smooth.y - flat.y)));
+                error = MAX(error, distance);
+            }
+
+            int subdivisions = (int) ceil(sqrt(error / w->tolerance));
+            w->cell_subdivisions[(r * (w->columns - 1)) + c] = CLAMP(subdivisions, 1, CONFIG_SURFACE_MAX_SUBDIVISIONS);
+        }
+    }
+}
+
+static void config_surface_tessellate_task(void *data, int begin, int end) {
+    config_surface_work *w = (config_surface_work*) data;
+
+    for (int i = begin; i < end; i++) {
+        int r = w->row_cells[i];
+        double s = w->row_offsets[i];
+
+        for (int j = 0; j < w->count_columns; j++) {
+            int c = w->column_cells[j];
+            double t = w->column_offsets[j];
+            int index = (i * w->count_columns) + j;
+
+            w->input_points[index] = config_surface_bilinear(w->mapping->input_points, w->columns, r, c, s, t);
+            w->output_points[index] = config_surface_eval(w, r, c, s, t);
+        }
+    }
+}
+
+static int config_surface_count_lines(int *subdivisions, int count_cells, int max_subdivisions) {
+    int count = 1;
+
+    for (int i = 0; i < count_cells; i++) {
+        count += MIN(subdivisions[i], max_subdivisions);
+    }
+
+    return count;
+}
+
+// Places the lines of each cell at even offsets, the last one on the far border
+static void config_surface_place_lines(int *subdivisions, int count_cells, int max_subdivisions, int *cells, double *offsets) {
+    int line = 0;
+
+    for (int i = 0; i < count_cells; i++) {
+        int count = MIN(subdivisions[i], max_subdivisions);
+
+        for (int j = 0; j < count; j++) {
+            cells[line] = i;
+            offsets[line] = (double) j / (double) count;
+            line++;
+        }
+    }
+
+    cells[line] = count_cells - 1;
+    offsets[line] = 1.0;
+}
+
+void config_surface_build(config_point_mapping *mapping, config_point_mapping *out, arena *arena) {
+    memset(out, 0, sizeof(config_point_mapping));
+
+    if (mapping->interpolation != CONFIG_POINT_MAPPING_BICUBIC) {
+        return;
+    }
+
+    int columns = config_mesh_grid_columns(mapping);
+
+    if (columns == 0) {
+        log_debug("Bicubic point mapping needs a grid of points, using it linear\n");
+        return;
+    }
+
+    config_surface_work w;
+    memset(&w, 0, sizeof(w));
+
+    w.mapping = mapping;
+    w.rows = mapping->count_points / columns;
+    w.columns = columns;
+    w.tolerance = mapping->surface_tolerance > 0.0 ? mapping->surface_tolerance : CONFIG_SURFACE_DEFAULT_TOLERANCE;
+
+    int count_cell_rows = w.rows - 1;
+    int count_cell_columns = w.columns - 1;
+
+    w.cell_subdivisions = (int*) malloc(count_cell_rows * count_cell_columns * sizeof(int));
+    parallel_for(count_cell_rows, 4, config_surface_estimate_task, &w);
+
+    // Rows and columns of cells share their subdivisions, the tessellation stays a grid
+    int *row_subdivisions = (int*) calloc(count_cell_rows, sizeof(int));
+    int *column_subdivisions = (int*) calloc(count_cell_columns, sizeof(int));
+
+    for (int r = 0; r < count_cell_rows; r++) {
+        for (int c = 0; c < count_cell_columns; c++) {
+            int subdivisions = w.cell_subdivisions[(r * count_cell_columns) + c];
+
+            row_subdivisions[r] = MAX(row_subdivisions[r], subdivisions);
+            column_subdivisions[c] = MAX(column_subdivisions[c], subdivisions);
+        }
+    }
+
+    int max_subdivisions = CONFIG_SURFACE_MAX_SUBDIVISIONS;
+
+    while (max_subdivisions > 1 &&
+        (long long) config_surface_count_lines(row_subdivisions, count_cell_rows, max_subdivisions) *
+        config_surface_count_lines(column_subdivisions, count_cell_columns, max_subdivisions) > CONFIG_SURFACE_MAX_POINTS) {
+        max_subdivisions--;
+    }
+
+    if (max_subdivisions < CONFIG_SURFACE_MAX_SUBDIVISIONS) {
+        log_debug("Bicubic point mapping capped to %i subdivisions per cell, tolerance not met\n", max_subdivisions);
+    }
+
+    w.count_rows = config_surface_count_lines(row_subdivisions, count_cell_rows, max_subdivisions);
+    w.count_columns = config_surface_count_lines(column_subdivisions, count_cell_columns, max_subdivisions);
+
+    w.row_cells = (int*) malloc(w.count_rows * sizeof(int));
+    w.row_offsets = (double*) malloc(w.count_rows * sizeof(double));
+    w.column_cells = (int*) malloc(w.count_columns * sizeof(int));
+    w.column_offsets = (double*) malloc(w.count_columns * sizeof(double));
+
+    config_surface_place_lines(row_subdivisions, count_cell_rows, max_subdivisions, w.row_cells, w.row_offsets);
+    config_surface_place_lines(column_subdivisions, count_cell_columns, max_subdivisions, w.column_cells, w.column_offsets);
+
+    int count_points = w.count_rows * w.count_columns;
+
+    w.input_points = (config_point*) config_surface_alloc(arena, count_points * sizeof(config_point));
+    w.output_points = (config_point*) config_surface_alloc(arena, count_points * sizeof(config_point));
+
+    parallel_for(w.count_rows, 16, config_surface_tessellate_task, &w);
+
+    out->input_points = w.input_points;
+    out->output_points = w.output_points;
+    out->count_points = count_points;
+    out->grid_columns = w.count_columns;
+    out->output_horizontal_adjust_factor = mapping->output_horizontal_adjust_factor;
+    out->output_vertical_adjust_factor = mapping->output_vertical_adjust_factor;
+
+    log_debug("Bicubic point mapping of %i points tessellated into %ix%i\n", mapping->count_points, w.count_columns, w.count_rows);
+
+    free(w.cell_subdivisions);
+    free(row_subdivisions);
+    free(column_subdivisions);
+    free(w.row_cells);
+    free(w.row_offsets);
+    free(w.column_cells);
+    free(w.column_offsets);
+}
+
+void config_surface_free(config_point_mapping *surface) {
+    if (surface->input_points) {
+        free(surface->input_points);
+    }
+
+    if (surface->output_points) {
+        free(surface->output_points);
+    }
+
+    memset(surface, 0, sizeof(config_point_mapping));
+}
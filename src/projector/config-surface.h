@@ -0,0 +1,21 @@
+#include "config-structs.h"
+#include "arena.h"
+
+#ifndef _CONFIG_SURFACE_H_
+#define _CONFIG_SURFACE_H_
+
+// Bicubic point mappings: output points are joined by a Catmull-Rom surface,
+// tessellated into a dense linear grid mapping before triangulation.
+#define CONFIG_SURFACE_DEFAULT_TOLERANCE 0.5
+#define CONFIG_SURFACE_MAX_SUBDIVISIONS 32
+#define CONFIG_SURFACE_MAX_POINTS (1024 * 1024)
+
+// Subdivides each control grid cell until its triangles are within the
+// surface tolerance. Input points are interpolated linearly in each cell.
+// Runs on worker threads. out has no points when the mapping is linear or its
+// input points are not a grid. Arrays are allocated from arena, or the heap
+// when NULL, config_surface_free is for heap allocated ones only.
+void config_surface_build(config_point_mapping *mapping, config_point_mapping *out, arena *arena);
+void config_surface_free(config_point_mapping *surface);
+
+#endif
@@ -0,0 +1,208 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "custom-math.h"
+#include "config-mesh.h"
+#include "config-surface.h"
+#include "config-warp-query.h"
+
+static void config_warp_query_cell(config_warp_query_grid *grid, double x, double y, int *column, int *row) {
+    int c = (int) floor((x - grid->x) / grid->cell_w);
+    int r = (int) floor((y - grid->y) / grid->cell_h);
+
+    *column = CLAMP(c, 0, grid->columns - 1);
+    *row = CLAMP(r, 0, grid->rows - 1);
+}
+
+static void config_warp_query_grid_build(config_warp_query_grid *grid, config_point *points, int count_points, int *indexes, int count_triangles) {
+    double min_x = 0.0, min_y = 0.0, max_x = 0.0, max_y = 0.0;
+
+    for (int i = 0; i < count_points; i++) {
+        if (i == 0 || points[i].x < min_x) min_x = points[i].x;
+        if (i == 0 || points[i].x > max_x) max_x = points[i].x;
+        if (i == 0 || points[i].y < min_y) min_y = points[i].y;
+        if (i == 0 || points[i].y > max_y) max_y = points[i].y;
+    }
+
+    double w = max_x > min_x ? max_x - min_x : 1.0;
+    double h = max_y > min_y ? max_y - min_y : 1.0;
+
+    // About one cell per triangle, square cells
+    int count_cells = CLAMP(count_triangles, 1, CONFIG_WARP_QUERY_MAX_CELLS);
+    int columns = (int) ceil(sqrt(count_cells * (w / h)));
+
+    columns = CLAMP(columns, 1, count_cells);
+
+    grid->x = min_x;
+    grid->y = min_y;
+    grid->columns = columns;
+    grid->rows = (count_cells + columns - 1) / columns;
+    grid->cell_w = w / grid->columns;
+    grid->cell_h = h / grid->rows;
+
+    count_cells = grid->columns * grid->rows;
+    grid->first = (int*) calloc(count_cells + 1, sizeof(int));
+
+    // Counted, then filled, over the cells of each triangle bounding box
+    for (int pass = 0; pass < 2; pass++) {
+        int *cursor = NULL;
+
+        if (pass == 1) {
+            for (int i = 0; i < count_cells; i++) {
+                grid->first[i + 1] += grid->first[i];
+            }
+
+            grid->triangles = (int*) malloc(MAX(grid->first[count_cells], 1) * sizeof(int));
+            cursor = (int*) malloc(count_cells * sizeof(int));
+            memcpy(cursor, grid->first, count_cells * sizeof(int));
+        }
+
+        for (int t = 0; t < count_triangles; t++) {
+            config_point *a = &points[indexes[t * 3]];
+            config_point *b = &points[indexes[(t * 3) + 1]];
+            config_point *c = &points[indexes[(t * 3) + 2]];
+
+            int c0, r0, c1, r1;
+            config_warp_query_cell(grid, MIN(a->x, MIN(b->x, c->x)), MIN(a->y, MIN(b->y, c->y)), &c0, &r0);
+            config_warp_query_cell(grid, MAX(a->x, MAX(b->x, c->x)), MAX(a->y, MAX(b->y, c->y)), &c1, &r1);
+
+            for (int r = r0; r <= r1; r++) {
+                for (int col = c0; col <= c1; col++) {
+                    int cell = (r * grid->columns) + col;
+
+                    if (pass == 0) {
+                        grid->first[cell + 1]++;
+                    } else {
+                        grid->triangles[cursor[cell]++] = t;
+                    }
+                }
+            }
+        }
+
+        if (cursor) {
+            free(cursor);
+        }
+    }
+}
+
+static void config_warp_query_grid_free(config_warp_query_grid *grid) {
+    if (grid->first) {
+        free(grid->first);
+    }
+
+    if (grid->triangles) {
+        free(grid->triangles);
+    }
+}
+
+// Finds the triangle of from_points covering x, y and interpolates to_points
+static int config_warp_query_locate(config_warp_query *query, config_warp_query_grid *grid, config_point *from_points, config_point *to_points, double x, double y, config_warp_query_result *out) {
+    if (grid->first == NULL ||
+        x < grid->x || y < grid->y ||
+        x > grid->x + (grid->cell_w * grid->columns) || y > grid->y + (grid->cell_h * grid->rows)) {
+        return 0;
+    }
+
+    int column, row;
+    config_warp_query_cell(grid, x, y, &column, &row);
+
+    int cell = (row * grid->columns) + column;
+    int *indexes = query->triangles->indexes;
+
+    for (int i = grid->first[cell]; i < grid->first[cell + 1]; i++) {
+        int t = grid->triangles[i];
+        int *v = &indexes[t * 3];
+
+        config_point *a = &from_points[v[0]];
+        config_point *b = &from_points[v[1]];
+        config_point *c = &from_points[v[2]];
+
+        double area = ((b->x - a->x) * (c->y - a->y)) - ((b->y - a->y) * (c->x - a->x));
+
+        if (area == 0.0) {
+            continue;
+        }
+
+        double l0 = (((b->x - x) * (c->y - y)) - ((b->y - y) * (c->x - x))) / area;
+        double l1 = (((c->x - x) * (a->y - y)) - ((c->y - y) * (a->x - x))) / area;
+        double l2 = 1.0 - l0 - l1;
+
+        // Points on shared edges belong to either triangle
+        if (l0 < -1e-9 || l1 < -1e-9 || l2 < -1e-9) {
+            continue;
+        }
+
+        out->triangle = t;
+        out->indexes[0] = v[0];
+        out->indexes[1] = v[1];
+        out->indexes[2] = v[2];
+        out->barycentric[0] = l0;
+        out->barycentric[1] = l1;
+        out->barycentric[2] = l2;
+        out->point.x = (l0 * to_points[v[0]].x) + (l1 * to_points[v[1]].x) + (l2 * to_points[v[2]].x);
+        out->point.y = (l0 * to_points[v[0]].y) + (l1 * to_points[v[1]].y) + (l2 * to_points[v[2]].y);
+
+        return 1;
+    }
+
+    return 0;
+}
+
+void config_warp_query_build(config_virtual_screen *config, config_warp_query *out) {
+    config_virtual_screen built_config = *config;
+
+    memset(out, 0, sizeof(config_warp_query));
+
+    // Not built by config_build_meshes, same as config_mesh_build
+    if (built_config.surface.count_points == 0) {
+        config_surface_build(&config->monitor_position, &built_config.surface, NULL);
+    }
+
+    config_point_mapping *mapping = config_mesh_mapping(&built_config);
+    size_t points_size = mapping->count_points * sizeof(config_point);
+
+    out->count_points = mapping->count_points;
+    out->input_points = (config_point*) malloc(points_size);
+    out->output_points = (config_point*) malloc(points_size);
+
+    memcpy(out->input_points, mapping->input_points, points_size);
+    memcpy(out->output_points, mapping->output_points, points_size);
+
+    // Same triangles as the mesh, kept in the cache while the query lives
+    out->triangles = config_mesh_cache_acquire(mapping);
+
+    config_warp_query_grid_build(&out->input_grid, out->input_points, out->count_points, out->triangles->indexes, out->triangles->count_triangles);
+    config_warp_query_grid_build(&out->output_grid, out->output_points, out->count_points, out->triangles->indexes, out->triangles->count_triangles);
+
+    if (config->surface.count_points == 0) {
+        config_surface_free(&built_config.surface);
+    }
+}
+
+void config_warp_query_free(config_warp_query *query) {
+    if (query->triangles) {
+        config_mesh_cache_release(query->triangles);
+    }
+
+    if (query->input_points) {
+        free(query->input_points);
+    }
+
+    if (query->output_points) {
+        free(query->output_points);
+    }
+
+    config_warp_query_grid_free(&query->input_grid);
+    config_warp_query_grid_free(&query->output_grid);
+
+    memset(query, 0, sizeof(config_warp_query));
+}
+
+int config_warp_query_forward(config_warp_query *query, double x, double y, config_warp_query_result *out) {
+    return config_warp_query_locate(query, &query->input_grid, query->input_points, query->output_points, x, y, out);
+}
+
+int config_warp_query_inverse(config_warp_query *query, double x, double y, config_warp_query_result *out) {
+    return config_warp_query_locate(query, &query->output_grid, query->output_points, query->input_points, x, y, out);
+}
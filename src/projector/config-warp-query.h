@@ -0,0 +1,57 @@
+#include "config-structs.h"
+#include "config-mesh-cache.h"
+
+#ifndef _CONFIG_WARP_QUERY_H_
+#define _CONFIG_WARP_QUERY_H_
+
+// Point queries through the warp mesh of a virtual screen, for calibration
+// tooling: forward from a virtual screen pixel (input point) to the display
+// pixel it lands on (output point), and inverse. Triangles are bucketed in a
+// uniform grid over each side, about one cell per triangle, so a query tests
+// a few triangles whatever the mesh size.
+#define CONFIG_WARP_QUERY_MAX_CELLS (1024 * 1024)
+
+typedef struct {
+    double x, y;
+    double cell_w, cell_h;
+    int columns, rows;
+
+    // Triangles overlapping each cell, in compressed rows
+    int *first;
+    int *triangles;
+} config_warp_query_grid;
+
+typedef struct {
+    int count_points;
+    config_point *input_points;
+    config_point *output_points;
+
+    config_mesh_triangles *triangles;
+
+    config_warp_query_grid input_grid;
+    config_warp_query_grid output_grid;
+} config_warp_query;
+
+typedef struct {
+    // Point on the other side
+    config_point point;
+
+    int triangle;
+    int indexes[3];
+
+    // Weights of the triangle points, summing to 1
+    double barycentric[3];
+} config_warp_query_result;
+
+// Indexes the triangulation of the mapping the virtual screen mesh is built
+// from (see config_mesh_mapping). Points are copied, the query outlives the
+// config. Read only once built, queries are safe from any thread.
+void config_warp_query_build(config_virtual_screen *config, config_warp_query *out);
+void config_warp_query_free(config_warp_query *query);
+
+// Return 0 when no triangle covers the point. Where the warp folds over
+// itself, forward queries return one of the overlapping triangles.
+int config_warp_query_forward(config_warp_query *query, double x, double y, config_warp_query_result *out);
+int config_warp_query_inverse(config_warp_query *query, double x, double y, config_warp_query_result *out);
+
+#endif
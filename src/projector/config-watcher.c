@@ -0,0 +1,171 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include <uv.h>
+
+#include "tinycthread.h"
+#include "clock.h"
+#include "debug.h"
+#include "trace.h"
+#include "config.h"
+#include "config-watcher.h"
+
+static uv_loop_t watcher_loop;
+static uv_fs_event_t fs_event;
+static uv_timer_t debounce_timer;
+static uv_async_t stop_async;
+
+static thrd_t watcher_thread_id;
+static int watcher_running = 0;
+
+static char *watched_file_path = NULL;
+static char *watched_dir = NULL;
+static char *watched_file_name = NULL;
+
+static config_watcher_callback watcher_callback;
+
+static char* internal_config_watcher_copy(const char *str, size_t length) {
+    char *result = (char*) malloc(length + 1);
+
+    memcpy(result, str, length);
+    result[length] = 0;
+
+    return result;
+}
+
+char* config_watcher_expand_path(const char *path) {
+    if (path[0] != '~') {
+        return internal_config_watcher_copy(path, strlen(path));
+    }
+
+    char home[1024];
+    size_t home_size = sizeof(home);
+
+    int result = uv_os_homedir(home, &home_size);
+
+    if (result != 0) {
+        log_debug("Failed to get home directory: %s\n", uv_strerror(result));
+        return internal_config_watcher_copy(path, strlen(path));
+    }
+
+    size_t path_length = strlen(path + 1);
+    char *expanded = (char*) malloc(home_size + path_length + 1);
+
+    memcpy(expanded, home, home_size);
+    memcpy(expanded + home_size, path + 1, path_length + 1);
+
+    return expanded;
+}
+
+static void internal_config_watcher_split_path(const char *path) {
+    const char *separator = NULL;
+
+    for (const char *c = path; *c; c++) {
+        if (*c == '/' || *c == '\\') {
+            separator = c;
+        }
+    }
+
+    if (separator == NULL) {
+        watched_dir = internal_config_watcher_copy(".", 1);
+        watched_file_name = internal_config_watcher_copy(path, strlen(path));
+    } else {
+        watched_dir = internal_config_watcher_copy(path, separator == path ? 1 : separator - path);
+        watched_file_name = internal_config_watcher_copy(separator + 1, strlen(separator + 1));
+    }
+}
+
+static void internal_config_watcher_reload(uv_timer_t *handle) {
+    unsigned long long begin_ns = get_time_ns();
+
+    projection_config *config = load_config(watched_file_path);
+
+    unsigned long long end_ns = get_time_ns();
+    trace_complete_event("Config Parse", begin_ns, end_ns);
+
+    if (config == NULL) {
+        log_debug("Config file changed but could not be loaded. Keeping current config\n");
+        return;
+    }
+
+    log_debug("Config file changed. Parsed in %.3fms\n", (end_ns - begin_ns) / 1.0e6);
+
+    watcher_callback(config);
+}
+
+static void internal_config_watcher_fs_event(uv_fs_event_t *handle, const char *filename, int events, int status) {
+    if (status < 0) {
+        log_debug("Config watcher error: %s\n", uv_strerror(status));
+        return;
+    }
+
+    // The whole directory is watched, so editors replacing the file on save are still seen
+    if (filename && strcmp(filename, watched_file_name) != 0) {
+        return;
+    }
+
+    uv_timer_start(&debounce_timer, internal_config_watcher_reload, CONFIG_WATCHER_DEBOUNCE_MS, 0);
+}
+
+static void internal_config_watcher_stop(uv_async_t *handle) {
+    uv_fs_event_stop(&fs_event);
+    uv_timer_stop(&debounce_timer);
+
+    uv_close((uv_handle_t*) &fs_event, NULL);
+    uv_close((uv_handle_t*) &debounce_timer, NULL);
+    uv_close((uv_handle_t*) &stop_async, NULL);
+}
+
+static int internal_config_watcher_loop(void *_) {
+    trace_set_thread_name("Projector Config Watcher");
+
+    uv_run(&watcher_loop, UV_RUN_DEFAULT);
+    uv_loop_close(&watcher_loop);
+
+    return 0;
+}
+
+void config_watcher_start(const char *file_path, config_watcher_callback callback) {
+    if (watcher_running) {
+        return;
+    }
+
+    watcher_callback = callback;
+    watched_file_path = internal_config_watcher_copy(file_path, strlen(file_path));
+    internal_config_watcher_split_path(watched_file_path);
+
+    uv_loop_init(&watcher_loop);
+    uv_timer_init(&watcher_loop, &debounce_timer);
+    uv_async_init(&watcher_loop, &stop_async, internal_config_watcher_stop);
+    uv_fs_event_init(&watcher_loop, &fs_event);
+
+    int result = uv_fs_event_start(&fs_event, internal_config_watcher_fs_event, watched_dir, 0);
+
+    if (result != 0) {
+        log_debug("Failed to watch config dir %s: %s\n", watched_dir, uv_strerror(result));
+    } else {
+        log_debug("Watching config file %s\n", watched_file_path);
+    }
+
+    watcher_running = 1;
+    thrd_create(&watcher_thread_id, internal_config_watcher_loop, NULL);
+}
+
+void config_watcher_stop() {
+    if (!watcher_running) {
+        return;
+    }
+
+    uv_async_send(&stop_async);
+    thrd_join(watcher_thread_id, NULL);
+
+    watcher_running = 0;
+
+    free(watched_file_path);
+    free(watched_dir);
+    free(watched_file_name);
+
+    watched_file_path = NULL;
+    watched_dir = NULL;
+    watched_file_name = NULL;
+}
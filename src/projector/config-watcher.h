@@ -0,0 +1,20 @@
+#include "config-structs.h"
+
+#ifndef _CONFIG_WATCHER_H_
+#define _CONFIG_WATCHER_H_
+
+// Bursts of file events closer than this are handled as a single change.
+// Editors usually save with truncate + write + rename.
+#define CONFIG_WATCHER_DEBOUNCE_MS 250
+
+// Called on the watcher thread with a freshly parsed config.
+// The callback takes ownership of the config.
+typedef void (*config_watcher_callback)(projection_config *config);
+
+// Returns a malloc'd copy of path with a leading '~' replaced by the user home dir
+char* config_watcher_expand_path(const char *path);
+
+void config_watcher_start(const char *file_path, config_watcher_callback callback);
+void config_watcher_stop();
+
+#endif
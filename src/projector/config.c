@@ -1,13 +1,32 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdatomic.h>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <unistd.h>
+#endif
 
-#include "cJSON.h"
 #include "debug.h"
-#include "config-parse.h"
-#include "config-serialize.h"
+#include "clock.h"
+#include "arena.h"
+#include "config-cache.h"
+#include "config-mesh-cache.h"
+#include "config-mesh.h"
+#include "config-stream-parse.h"
+#include "config-stream-serialize.h"
+#include "config-surface.h"
 #include "config.h"
 
+// Smallest arena block, enough for the per reload objects of cache mapped configs
+#define CONFIG_ARENA_BLOCK_SIZE (16 * 1024)
+
+// Parsed points plus their mesh points and mesh take about three times the
+// JSON size, so the first arena block usually holds the whole config
+#define CONFIG_ARENA_JSON_FACTOR 3
+
 static projection_config default_config;
 
 void free_config_point_mapping(config_point_mapping *in) {
@@ -34,6 +53,9 @@ void free_config_virtual_screen(config_virtual_screen *in) {
     }
 
     free_config_point_mapping(&in->monitor_position);
+    config_surface_free(&in->surface);
+    config_mesh_points_free(&in->mesh_points);
+    config_mesh_free(&in->mesh);
 }
 
 void free_config_display(config_display *in) {
@@ -48,19 +70,34 @@ void free_config_display(config_display *in) {
 
 
 void free_projection_config(projection_config *in) {
-    if (in == &default_config) {
+    if (in == NULL || in == &default_config) {
         return;
     }
 
-    for (int i = 0; i < in->count_display; i++) {
-        free_config_display(&in->display[i]);
+    arena *config_arena = in->arena;
+
+    if (in->cache_mapping) {
+        config_cache_release(in);
+    } else if (config_arena == NULL) {
+        for (int i = 0; i < in->count_display; i++) {
+            free_config_display(&in->display[i]);
+        }
+
+        if (in->display) {
+            free(in->display);
+        }
+
+        free(in);
     }
 
-    if (in->display) {
-        free(in->display);
+    // Holds the config itself unless cache mapped
+    if (config_arena) {
+        arena_destroy(config_arena);
     }
+}
 
-    free(in);
+void* config_alloc(projection_config *config, size_t size) {
+    return arena_alloc(config->arena, size);
 }
 
 projection_config* config_get_default() {
@@ -82,60 +119,136 @@ projection_config* load_config(const char *filePath) {
         return NULL;
     }
 
-    fseek(config_file, 0L, SEEK_END);
+    unsigned long long begin_ns = get_time_ns();
 
-    size_t size = ftell(config_file);
+    // Hash first, so a cache hit skips parsing entirely
+    char *chunk = (char*) malloc(CONFIG_STREAM_BUFFER_SIZE);
+    unsigned long long hash = CONFIG_CACHE_HASH_SEED;
+    size_t read_bytes;
+    size_t file_size = 0;
+
+    while ((read_bytes = fread(chunk, 1, CONFIG_STREAM_BUFFER_SIZE, config_file)) > 0) {
+        hash = config_cache_hash(hash, chunk, read_bytes);
+        file_size += read_bytes;
+    }
 
-    log_debug("File string size %lu\n", size);
+    free(chunk);
 
-    if (size > 1024 * 1024) {
-        log_debug("Config file too large. Skipped loading this config\n");
+    if (ferror(config_file)) {
+        log_debug("Failed reading config file\n");
+        perror(NULL);
         fclose(config_file);
         return NULL;
     }
 
-    fseek(config_file, 0L, SEEK_SET);
+    projection_config *config = config_cache_load(filePath, hash);
+
+    if (config) {
+        fclose(config_file);
+        config->arena = arena_create(CONFIG_ARENA_BLOCK_SIZE);
+        log_debug("Config loaded from compiled cache in %.3fms: '%s'\n", (get_time_ns() - begin_ns) / 1.0e6, filePath);
+        return config;
+    }
 
-    char *config_json_string = malloc(size);
-    size_t read_size = 0;
-    size_t current_read_bytes = 0;
+    rewind(config_file);
 
-    do {
-        char* dst = config_json_string + read_size;
+    unsigned long long parsed_hash;
+    arena *config_arena = arena_create(CONFIG_ARENA_BLOCK_SIZE + (file_size * CONFIG_ARENA_JSON_FACTOR));
 
-        current_read_bytes = fread(dst, 1, size - read_size, config_file);
+    config = (projection_config*) arena_alloc(config_arena, sizeof(projection_config));
+    config->arena = config_arena;
 
-        read_size += current_read_bytes;
-    } while (current_read_bytes > 0 && read_size < size);
+    int success = stream_parse_projection_config(config_file, config, &parsed_hash);
 
     fclose(config_file);
 
-    if (read_size != size) {
-        log_debug("Failed reading json data. Read size %lu; Expected %lu\n", read_size, size);
+    if (!success) {
+        free_projection_config(config);
+        return NULL;
+    }
 
-        perror(NULL);
+#ifdef ENABLE_MESH_DISK_CACHE
+    config_mesh_cache_load_file(filePath);
+#endif
 
-        free(config_json_string);
-        return NULL;
+    config_build_meshes(config);
+
+#ifdef ENABLE_MESH_DISK_CACHE
+    config_mesh_cache_save_file(filePath);
+#endif
+
+    config_mesh_cache_stats mesh_stats;
+    config_mesh_cache_get_stats(&mesh_stats);
+
+    log_debug(
+        "Mesh cache: %llu hits, %llu misses (%llu grids, %llu incremental), %llu evictions, %i entries using %.1fMB\n",
+        mesh_stats.hits, mesh_stats.misses, mesh_stats.grids, mesh_stats.incremental, mesh_stats.evictions, mesh_stats.count_entries, mesh_stats.memory / (1024.0 * 1024.0));
+
+    // Skip caching if the file was rewritten while being read, the watcher reloads it again
+    if (parsed_hash == hash) {
+        config_cache_store(filePath, hash, config);
     }
 
-    cJSON *json = cJSON_ParseWithLength(config_json_string, size);
-    free(config_json_string);
+    log_debug("Config file parse success in %.3fms: '%s'\n", (get_time_ns() - begin_ns) / 1.0e6, filePath);
 
-    if (json == NULL) {
-        const char *error_ptr = cJSON_GetErrorPtr();
-        log_debug("Config JSON parse error: %s\n", error_ptr);
-        return NULL;
+    return config;
+}
+
+static atomic_uint temp_file_counter = 0;
+
+char* temp_file_path(const char *file_path) {
+#ifdef _WIN32
+    unsigned long pid = (unsigned long) GetCurrentProcessId();
+#else
+    unsigned long pid = (unsigned long) getpid();
+#endif
+    size_t size = strlen(file_path) + 40;
+    char *path = (char*) malloc(size);
+
+    snprintf(path, size, "%s.%lu.%u.tmp", file_path, pid, atomic_fetch_add(&temp_file_counter, 1));
+
+    return path;
+}
+
+int replace_file(const char *temp_path, const char *file_path) {
+#ifdef _WIN32
+    return MoveFileExA(temp_path, file_path, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return rename(temp_path, file_path) == 0;
+#endif
+}
+
+int write_config(const char *file_path, projection_config *config, int pretty) {
+    char *temp_path = temp_file_path(file_path);
+
+    FILE* config_file;
+
+    open_file(&config_file, temp_path, "wb");
+
+    if (config_file == NULL) {
+        log_debug("Failed to write config file %s\n", temp_path);
+        free(temp_path);
+        return 0;
     }
 
-    projection_config *config = (projection_config*) malloc(sizeof(projection_config));
-    parse_projection_config(json, config);
+    unsigned long long begin_ns = get_time_ns();
 
-    cJSON_Delete(json);
+    int success = stream_serialize_projection_config(config_file, config, pretty);
+    success = (fclose(config_file) == 0) && success;
 
-    log_debug("Config file parse success: '%s'\n", filePath);
+    // The file watcher only ever sees a complete config
+    success = success && replace_file(temp_path, file_path);
 
-    return config;
+    if (success) {
+        log_debug("Config file written in %.3fms: '%s'\n", (get_time_ns() - begin_ns) / 1.0e6, file_path);
+    } else {
+        log_debug("Failed to write config file %s\n", file_path);
+        remove(temp_path);
+    }
+
+    free(temp_path);
+
+    return success;
 }
 
 void generate_config(const char *file_path) {
@@ -143,22 +256,31 @@ void generate_config(const char *file_path) {
         return;
     }
 
-    FILE* config_file;
-    
-    open_file(&config_file, file_path, "w");
+    write_config(file_path, &default_config, 1);
+}
 
-    if (config_file == NULL) {
-        return;
+int config_display_requires_restart(config_display *display1, config_display *display2) {
+    if (display1->monitor_bounds.x != display2->monitor_bounds.x) {
+        return 1;
     }
 
-    cJSON *json = serialize_projection_config(&default_config);
+    if (display1->monitor_bounds.y != display2->monitor_bounds.y) {
+        return 1;
+    }
 
-    char *config_json_string = cJSON_Print(json);
-    fwrite(config_json_string, strlen(config_json_string), 1, config_file);
-    fclose(config_file);
+    if (display1->monitor_bounds.w != display2->monitor_bounds.w) {
+        return 1;
+    }
 
-    free(config_json_string);
-    cJSON_Delete(json);
+    if (display1->monitor_bounds.h != display2->monitor_bounds.h) {
+        return 1;
+    }
+
+    if (display1->projection_enabled != display2->projection_enabled) {
+        return 1;
+    }
+
+    return 0;
 }
 
 int config_change_requires_restart(projection_config *config1, projection_config *config2) {
@@ -167,36 +289,84 @@ int config_change_requires_restart(projection_config *config1, projection_config
     }
 
     for (int i = 0; i < config1->count_display; i++) {
-        config_display *display1 = &config1->display[i];
-        config_display *display2 = &config2->display[i];
-
-        if (display1->monitor_bounds.x != display2->monitor_bounds.x) {
+        if (config_display_requires_restart(&config1->display[i], &config2->display[i])) {
             return 1;
         }
+    }
 
-        if (display1->monitor_bounds.y != display2->monitor_bounds.y) {
-            return 1;
-        }
+    return 0;
+}
 
-        if (display1->monitor_bounds.w != display2->monitor_bounds.w) {
-            return 1;
-        }
+static int config_bounds_equal(config_bounds *a, config_bounds *b) {
+    return a->x == b->x && a->y == b->y && a->w == b->w && a->h == b->h;
+}
 
-        if (display1->monitor_bounds.h != display2->monitor_bounds.h) {
-            return 1;
+static int config_points_equal(config_point *a, config_point *b, int count) {
+    for (int i = 0; i < count; i++) {
+        if (a[i].x != b[i].x || a[i].y != b[i].y) {
+            return 0;
         }
+    }
 
-        if (display1->projection_enabled != display2->projection_enabled) {
-            return 1;
+    return 1;
+}
+
+int config_virtual_screen_changes(config_virtual_screen *before, config_virtual_screen *after) {
+    int changes = 0;
+
+    if (before->w != after->w || before->h != after->h) {
+        changes |= CONFIG_VS_CHANGE_SIZE;
+    }
+
+    config_point_mapping *before_mapping = &before->monitor_position;
+    config_point_mapping *after_mapping = &after->monitor_position;
+
+    if (before_mapping->count_points != after_mapping->count_points ||
+        before_mapping->grid_columns != after_mapping->grid_columns ||
+        before_mapping->interpolation != after_mapping->interpolation ||
+        before_mapping->surface_tolerance != after_mapping->surface_tolerance ||
+        before->remap_warp != after->remap_warp ||
+        !config_points_equal(before_mapping->input_points, after_mapping->input_points, after_mapping->count_points) ||
+        !config_points_equal(before_mapping->output_points, after_mapping->output_points, after_mapping->count_points)) {
+        changes |= CONFIG_VS_CHANGE_MESH;
+    }
+
+    if (before->count_blends != after->count_blends) {
+        changes |= CONFIG_VS_CHANGE_BLEND_GEOMETRY;
+    } else {
+        for (int i = 0; i < after->count_blends; i++) {
+            config_blend *before_blend = &before->blends[i];
+            config_blend *after_blend = &after->blends[i];
+
+            if (before_blend->direction != after_blend->direction ||
+                !config_bounds_equal(&before_blend->position, &after_blend->position)) {
+                changes |= CONFIG_VS_CHANGE_BLEND_GEOMETRY;
+            }
+
+            if (before_blend->curve_exponent != after_blend->curve_exponent) {
+                changes |= CONFIG_VS_CHANGE_BLEND_CURVE;
+            }
         }
     }
 
-    return 0;
+    if (!config_bounds_equal(&before->render_input_bounds, &after->render_input_bounds)) {
+        changes |= CONFIG_VS_CHANGE_INPUT_BOUNDS;
+    }
+
+    return changes;
 }
 
 void prepare_default_config(config_bounds *default_monitor_bounds) {
-    default_config.display = (config_display*) calloc(1, sizeof(config_display));
-    default_config.display[0].virtual_screens = (config_virtual_screen*) calloc(1, sizeof(config_virtual_screen));
+    // Prepared again on every output start, the previous one is no longer in use
+    if (default_config.arena) {
+        arena_destroy(default_config.arena);
+    }
+
+    memset(&default_config, 0, sizeof(projection_config));
+    default_config.arena = arena_create(CONFIG_ARENA_BLOCK_SIZE);
+
+    default_config.display = (config_display*) config_alloc(&default_config, sizeof(config_display));
+    default_config.display[0].virtual_screens = (config_virtual_screen*) config_alloc(&default_config, sizeof(config_virtual_screen));
     default_config.count_display = 1;
 
     default_config.display[0].monitor_bounds.x = default_monitor_bounds->x;
@@ -221,7 +391,7 @@ void prepare_default_config(config_bounds *default_monitor_bounds) {
 
     default_config.display[0].virtual_screens[0].monitor_position.count_points = 4;
 
-    default_config.display[0].virtual_screens[0].monitor_position.input_points = (config_point*) calloc(4, sizeof(config_point));
+    default_config.display[0].virtual_screens[0].monitor_position.input_points = (config_point*) config_alloc(&default_config, 4 * sizeof(config_point));
 
     default_config.display[0].virtual_screens[0].monitor_position.input_points[0].x = 0.0;
     default_config.display[0].virtual_screens[0].monitor_position.input_points[0].y = 0.0;
@@ -235,7 +405,7 @@ void prepare_default_config(config_bounds *default_monitor_bounds) {
     default_config.display[0].virtual_screens[0].monitor_position.input_points[3].x = 0.0;
     default_config.display[0].virtual_screens[0].monitor_position.input_points[3].y = default_monitor_bounds->h;
 
-    default_config.display[0].virtual_screens[0].monitor_position.output_points = (config_point*) calloc(4, sizeof(config_point));
+    default_config.display[0].virtual_screens[0].monitor_position.output_points = (config_point*) config_alloc(&default_config, 4 * sizeof(config_point));
 
     default_config.display[0].virtual_screens[0].monitor_position.output_points[0].x = 0.0;
     default_config.display[0].virtual_screens[0].monitor_position.output_points[0].y = 0.0;
@@ -1,3 +1,5 @@
+#include <stddef.h>
+
 #include "config-structs.h"
 
 #ifndef _CONFIG_H_
@@ -21,8 +23,31 @@ void prepare_default_config(config_bounds *default_monitor_bounds);
 projection_config* config_get_default();
 projection_config* load_config(const char *file_path);
 void generate_config(const char *file_path);
+// Writes a temp file next to file_path and renames it over, returns 0 on failure
+int write_config(const char *file_path, projection_config *config, int pretty);
+// Unique temp file next to file_path, so concurrent writers never share one. Free after use.
+char* temp_file_path(const char *file_path);
+// Atomic where the platform allows, readers see the old or the new file
+int replace_file(const char *temp_path, const char *file_path);
 void free_projection_config(projection_config *in);
 
+// Zeroed memory freed together with the config, for per reload objects.
+// Configs from load_config and config_get_default always have an arena.
+void* config_alloc(projection_config *config, size_t size);
+
 int config_change_requires_restart(projection_config *config1, projection_config *config2);
+// The display window must be recreated, e.g. it moved to another monitor
+int config_display_requires_restart(config_display *display1, config_display *display2);
+
+// GPU resources of a virtual screen affected by a config change.
+// Colors, help lines, black levels and adjust factors are read on every
+// frame and never need a rebuild.
+#define CONFIG_VS_CHANGE_SIZE (1 << 0)
+#define CONFIG_VS_CHANGE_MESH (1 << 1)
+#define CONFIG_VS_CHANGE_BLEND_GEOMETRY (1 << 2)
+#define CONFIG_VS_CHANGE_BLEND_CURVE (1 << 3)
+#define CONFIG_VS_CHANGE_INPUT_BOUNDS (1 << 4)
+
+int config_virtual_screen_changes(config_virtual_screen *before, config_virtual_screen *after);
 
 #endif
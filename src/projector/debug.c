@@ -4,45 +4,142 @@
 #include <math.h>
 #include <stdio.h>
 
+#include <string.h>
+
+#include "tinycthread.h"
 #include "clock.h"
 #include "debug.h"
+#include "trace.h"
+
+#define MAX_TIME_MEASURES 256
 
-#ifdef _DEBUG
-#define LOG_FPS_INTERVAL_MS 1000
-#else
-#define LOG_FPS_INTERVAL_MS 5000
-#endif // _DEBUG
+static once_flag measures_once = ONCE_FLAG_INIT;
+static mtx_t measures_mutex;
+static time_measure* measures[MAX_TIME_MEASURES];
+static int measures_full_logged = 0;
+static unsigned long long measures_last_log_ns = 0;
+
+static void initialize_measures() {
+    mtx_init(&measures_mutex, 0);
+}
 
 time_measure* create_measure(char* name) {
     time_measure* tm = (time_measure*)calloc(1, sizeof(time_measure));
-    tm->name = name;
+
+    tm->name = (char*)malloc(strlen(name) + 1);
+    strcpy(tm->name, name);
+
+    histogram_init(&tm->durations);
+    atomic_init(&tm->references, 1);
+
+    call_once(&measures_once, initialize_measures);
+    mtx_lock(&measures_mutex);
+
+    int registered = 0;
+
+    for (int i = 0; i < MAX_TIME_MEASURES && !registered; i++) {
+        if (measures[i] == NULL) {
+            measures[i] = tm;
+            registered = 1;
+        }
+    }
+
+    // Still recorded and traced, only not logged
+    int log_full = !registered && !measures_full_logged;
+    measures_full_logged = measures_full_logged || !registered;
+
+    mtx_unlock(&measures_mutex);
+
+    if (log_full) {
+        log_debug("Too many measures, %s and later ones are not logged\n", tm->name);
+    }
+
     return tm;
 }
+
+static void release_measure(time_measure* tm) {
+    if (atomic_fetch_sub(&tm->references, 1) == 1) {
+        free(tm->name);
+        free(tm);
+    }
+}
+
 void begin_measure(time_measure* tm) {
-    get_time(&tm->current);
+    tm->begin_ns = get_time_ns();
 }
+
 void end_measure(time_measure* tm) {
-    struct timespec now;
+    unsigned long long end_ns = get_time_ns();
 
-    get_time(&now);
+    histogram_record(&tm->durations, end_ns - tm->begin_ns);
 
-    unsigned long long current_ms = get_delta_time_ms(&now, &tm->current);
+    if (trace_enabled()) {
+        trace_complete_event(tm->name, tm->begin_ns, end_ns);
+    }
+}
+
+void destroy_measure(time_measure* tm) {
+    if (tm == NULL) {
+        return;
+    }
 
-    tm->count++;
-    tm->total_ms += current_ms;
+    call_once(&measures_once, initialize_measures);
+    mtx_lock(&measures_mutex);
 
-    if (tm->count > 300) {
-       // log_debug("Measure %s average duration: %llu\n", tm->name, tm->total_ms / tm->count);
-        tm->total_ms = current_ms;
-        tm->count = 1;
+    for (int i = 0; i < MAX_TIME_MEASURES; i++) {
+        if (measures[i] == tm) {
+            measures[i] = NULL;
+        }
     }
 
-    unsigned long long average_ms = tm->total_ms / tm->count;
+    mtx_unlock(&measures_mutex);
+
+    release_measure(tm);
+}
+
+void log_measures() {
+    unsigned long long now = get_time_ns();
+
+    if (now - measures_last_log_ns < LOG_FPS_INTERVAL_MS * 1000000ULL) {
+        return;
+    }
+
+    measures_last_log_ns = now;
+
+    time_measure* registered[MAX_TIME_MEASURES];
+    int count_registered = 0;
+
+    // Snapshots and logging run unlocked, creating and destroying measures never waits on them
+    call_once(&measures_once, initialize_measures);
+    mtx_lock(&measures_mutex);
+
+    for (int i = 0; i < MAX_TIME_MEASURES; i++) {
+        if (measures[i]) {
+            atomic_fetch_add(&measures[i]->references, 1);
+            registered[count_registered++] = measures[i];
+        }
+    }
+
+    mtx_unlock(&measures_mutex);
+
+    for (int i = 0; i < count_registered; i++) {
+        time_measure* tm = registered[i];
+        histogram_snapshot snapshot;
+
+        histogram_take_snapshot(&tm->durations, &snapshot);
+
+        if (snapshot.count > 0) {
+            log_debug(
+                "Measure %s: n=%llu min=%.3fms p50=%.3fms p99=%.3fms max=%.3fms\n",
+                tm->name,
+                snapshot.count,
+                snapshot.min / 1.0e6,
+                snapshot.p50 / 1.0e6,
+                snapshot.p99 / 1.0e6,
+                snapshot.max / 1.0e6);
+        }
 
-    if (current_ms > average_ms + 15) {
-#ifdef _DEBUG
-        log_debug("Measure %s greater than avg. avg=%llu took=%llu\n", tm->name, average_ms, current_ms);
-#endif
+        release_measure(tm);
     }
 }
 
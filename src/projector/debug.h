@@ -4,9 +4,17 @@
 #include <obs-module.h>
 #include <plugin-support.h>
 
+#include "histogram.h"
+
 #ifndef _DEBUG_H_
 #define _DEBUG_H_
 
+#ifdef _DEBUG
+#define LOG_FPS_INTERVAL_MS 1000
+#else
+#define LOG_FPS_INTERVAL_MS 5000
+#endif // _DEBUG
+
 #define log_debug(...) {\
     obs_log(LOG_INFO, __VA_ARGS__);\
     fflush(stdout);\
@@ -14,14 +22,20 @@
 
 typedef struct {
     char* name;
-    int count;
-    struct timespec current;
-    unsigned long long total_ms;
+    unsigned long long begin_ns;
+    histogram durations;
+    // Owner plus log_measures while it snapshots, the last release frees it
+    atomic_int references;
 } time_measure;
 
 time_measure* create_measure(char *name);
 void begin_measure(time_measure* tm);
 void end_measure(time_measure* tm);
+void destroy_measure(time_measure* tm);
+
+// Snapshots every measure and logs min/p50/p99/max once per LOG_FPS_INTERVAL_MS.
+// Meant to be called from a background thread; never blocks measure recording.
+void log_measures();
 
 void register_render_frame();
 void register_monitor_frame();
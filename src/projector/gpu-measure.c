@@ -0,0 +1,139 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "clock.h"
+#include "debug.h"
+#include "ogl-loader.h"
+#include "gpu-measure.h"
+
+static int gpu_measure_supported() {
+#ifdef _GLEW_ENABLED_
+    return GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+#else
+    return 0;
+#endif
+}
+
+gpu_measure* create_gpu_measure(const char *name) {
+    gpu_measure *gm = (gpu_measure*) calloc(1, sizeof(gpu_measure));
+
+    gm->name = (char*) malloc(strlen(name) + 1);
+    strcpy(gm->name, name);
+
+    get_time(&gm->last_report);
+
+    return gm;
+}
+
+void internal_gpu_measure_report(gpu_measure *gm) {
+    struct timespec now;
+    get_time(&now);
+
+    if (get_delta_time_ms(&now, &gm->last_report) < LOG_FPS_INTERVAL_MS) {
+        return;
+    }
+
+    if (gm->count > 0) {
+        log_debug(
+            "GPU measure %s: avg=%.3fms min=%.3fms max=%.3fms samples=%i dropped=%i\n",
+            gm->name,
+            (gm->total_ns / (double) gm->count) / 1.0e6,
+            gm->min_ns / 1.0e6,
+            gm->max_ns / 1.0e6,
+            gm->count,
+            gm->dropped);
+    }
+
+    gm->count = 0;
+    gm->dropped = 0;
+    gm->total_ns = 0;
+    gm->min_ns = 0;
+    gm->max_ns = 0;
+
+    copy_time(&gm->last_report, &now);
+}
+
+void internal_gpu_measure_collect(gpu_measure *gm) {
+    // Walk from the oldest query. Results become available in submission
+    // order, so stop at the first one the GPU has not finished yet.
+    for (int i = 0; i < GPU_MEASURE_QUERY_COUNT; i++) {
+        int index = (gm->next_query + i) % GPU_MEASURE_QUERY_COUNT;
+
+        if (!gm->pending[index]) {
+            continue;
+        }
+
+        GLint available = 0;
+        glGetQueryObjectiv(gm->queries[index], GL_QUERY_RESULT_AVAILABLE, &available);
+
+        if (!available) {
+            break;
+        }
+
+        GLuint64 elapsed_ns = 0;
+        glGetQueryObjectui64v(gm->queries[index], GL_QUERY_RESULT, &elapsed_ns);
+
+        gm->pending[index] = 0;
+
+        if (gm->count == 0 || elapsed_ns < gm->min_ns) {
+            gm->min_ns = elapsed_ns;
+        }
+
+        if (elapsed_ns > gm->max_ns) {
+            gm->max_ns = elapsed_ns;
+        }
+
+        gm->total_ns += elapsed_ns;
+        gm->count++;
+    }
+
+    internal_gpu_measure_report(gm);
+}
+
+void begin_gpu_measure(gpu_measure *gm) {
+    if (!gpu_measure_supported()) {
+        return;
+    }
+
+    if (!gm->initialized) {
+        glGenQueries(GPU_MEASURE_QUERY_COUNT, gm->queries);
+        gm->initialized = 1;
+    }
+
+    internal_gpu_measure_collect(gm);
+
+    if (gm->pending[gm->next_query]) {
+        // GPU is more than GPU_MEASURE_QUERY_COUNT frames behind.
+        // Reuse the query and lose its sample instead of stalling.
+        gm->pending[gm->next_query] = 0;
+        gm->dropped++;
+    }
+
+    glBeginQuery(GL_TIME_ELAPSED, gm->queries[gm->next_query]);
+    gm->running = 1;
+}
+
+void end_gpu_measure(gpu_measure *gm) {
+    if (!gm->running) {
+        return;
+    }
+
+    glEndQuery(GL_TIME_ELAPSED);
+
+    gm->running = 0;
+    gm->pending[gm->next_query] = 1;
+    gm->next_query = (gm->next_query + 1) % GPU_MEASURE_QUERY_COUNT;
+}
+
+void destroy_gpu_measure(gpu_measure *gm) {
+    if (gm == NULL) {
+        return;
+    }
+
+    if (gm->initialized) {
+        glDeleteQueries(GPU_MEASURE_QUERY_COUNT, gm->queries);
+    }
+
+    free(gm->name);
+    free(gm);
+}
@@ -0,0 +1,37 @@
+#include <time.h>
+
+#include "ogl-loader.h"
+
+#ifndef _GPU_MEASURE_H_
+#define _GPU_MEASURE_H_
+
+// Results are read back this many frames later, so the CPU never waits for the GPU
+#define GPU_MEASURE_QUERY_COUNT 4
+
+typedef struct {
+    char *name;
+
+    int initialized;
+    int running;
+
+    GLuint queries[GPU_MEASURE_QUERY_COUNT];
+    int pending[GPU_MEASURE_QUERY_COUNT];
+    int next_query;
+
+    int count;
+    int dropped;
+    unsigned long long total_ns;
+    unsigned long long min_ns;
+    unsigned long long max_ns;
+
+    struct timespec last_report;
+} gpu_measure;
+
+// Query objects are not shared between contexts. A gpu_measure must be
+// begun, ended and destroyed always on the same GL context.
+gpu_measure* create_gpu_measure(const char *name);
+void begin_gpu_measure(gpu_measure *gm);
+void end_gpu_measure(gpu_measure *gm);
+void destroy_gpu_measure(gpu_measure *gm);
+
+#endif
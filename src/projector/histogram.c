@@ -0,0 +1,140 @@
+#include <string.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "custom-math.h"
+#include "histogram.h"
+
+static int histogram_msb(unsigned long long value) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return (int) index;
+#else
+    return 63 - __builtin_clzll(value);
+#endif
+}
+
+static int histogram_bucket_index(unsigned long long value) {
+    if (value < 2 * HISTOGRAM_SUB_BUCKET_COUNT) {
+        return (int) value;
+    }
+
+    int shift = histogram_msb(value) - HISTOGRAM_SUB_BUCKET_BITS;
+    int sub_bucket = (int) (value >> shift) - HISTOGRAM_SUB_BUCKET_COUNT;
+
+    return ((shift + 1) * HISTOGRAM_SUB_BUCKET_COUNT) + sub_bucket;
+}
+
+static unsigned long long histogram_bucket_value(int index) {
+    if (index < 2 * HISTOGRAM_SUB_BUCKET_COUNT) {
+        return index;
+    }
+
+    int shift = (index / HISTOGRAM_SUB_BUCKET_COUNT) - 1;
+    unsigned long long sub_bucket = (index % HISTOGRAM_SUB_BUCKET_COUNT) + HISTOGRAM_SUB_BUCKET_COUNT;
+
+    // Middle of the bucket range
+    return (sub_bucket << shift) + ((1ULL << shift) >> 1);
+}
+
+void histogram_init(histogram *h) {
+    for (int i = 0; i < HISTOGRAM_BUCKET_COUNT; i++) {
+        atomic_init(&h->counts[i], 0);
+    }
+
+    atomic_init(&h->sum, 0);
+    atomic_init(&h->min, ~0ULL);
+    atomic_init(&h->max, 0);
+
+    memset(h->last_counts, 0, sizeof(h->last_counts));
+    h->last_sum = 0;
+}
+
+void histogram_record(histogram *h, unsigned long long value) {
+    atomic_fetch_add_explicit(&h->counts[histogram_bucket_index(value)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->sum, value, memory_order_relaxed);
+
+    unsigned long long current = atomic_load_explicit(&h->min, memory_order_relaxed);
+    while (value < current && !atomic_compare_exchange_weak_explicit(&h->min, &current, value, memory_order_relaxed, memory_order_relaxed));
+
+    current = atomic_load_explicit(&h->max, memory_order_relaxed);
+    while (value > current && !atomic_compare_exchange_weak_explicit(&h->max, &current, value, memory_order_relaxed, memory_order_relaxed));
+}
+
+void histogram_take_snapshot(histogram *h, histogram_snapshot *out) {
+    unsigned long long counts[HISTOGRAM_BUCKET_COUNT];
+    unsigned long long total = 0;
+
+    for (int i = 0; i < HISTOGRAM_BUCKET_COUNT; i++) {
+        unsigned long long current = atomic_load_explicit(&h->counts[i], memory_order_relaxed);
+
+        counts[i] = current - h->last_counts[i];
+        h->last_counts[i] = current;
+
+        total += counts[i];
+    }
+
+    unsigned long long sum = atomic_load_explicit(&h->sum, memory_order_relaxed);
+    unsigned long long min = atomic_exchange_explicit(&h->min, ~0ULL, memory_order_relaxed);
+    unsigned long long max = atomic_exchange_explicit(&h->max, 0, memory_order_relaxed);
+
+    memset(out, 0, sizeof(histogram_snapshot));
+
+    out->count = total;
+    out->mean = total ? (sum - h->last_sum) / (double) total : 0.0;
+
+    h->last_sum = sum;
+
+    if (total == 0) {
+        return;
+    }
+
+    // A sample racing with this snapshot may be counted before it updates
+    // min/max. Fall back to bucket values then.
+    int first_bucket = -1;
+    int last_bucket = -1;
+
+    for (int i = 0; i < HISTOGRAM_BUCKET_COUNT; i++) {
+        if (counts[i]) {
+            last_bucket = i;
+
+            if (first_bucket < 0) {
+                first_bucket = i;
+            }
+        }
+    }
+
+    if (min > max) {
+        min = histogram_bucket_value(first_bucket);
+        max = histogram_bucket_value(last_bucket);
+    }
+
+    out->min = min;
+    out->max = max;
+
+    unsigned long long p50_rank = (total * 50 + 99) / 100;
+    unsigned long long p99_rank = (total * 99 + 99) / 100;
+    unsigned long long seen = 0;
+    int p50_found = 0;
+
+    for (int i = first_bucket; i <= last_bucket; i++) {
+        seen += counts[i];
+
+        if (!p50_found && seen >= p50_rank) {
+            out->p50 = histogram_bucket_value(i);
+            p50_found = 1;
+        }
+
+        if (seen >= p99_rank) {
+            out->p99 = histogram_bucket_value(i);
+            break;
+        }
+    }
+
+    // Bucket midpoints may fall outside the exact extremes
+    out->p50 = CLAMP(out->p50, min, max);
+    out->p99 = CLAMP(out->p99, min, max);
+}
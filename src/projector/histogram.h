@@ -0,0 +1,41 @@
+#include <stdatomic.h>
+
+#ifndef _HISTOGRAM_H_
+#define _HISTOGRAM_H_
+
+// Log-bucketed histogram (HDR histogram style).
+// Values below 2 * HISTOGRAM_SUB_BUCKET_COUNT are recorded exactly,
+// bigger values keep HISTOGRAM_SUB_BUCKET_BITS bits of precision (~3%).
+#define HISTOGRAM_SUB_BUCKET_BITS 5
+#define HISTOGRAM_SUB_BUCKET_COUNT (1 << HISTOGRAM_SUB_BUCKET_BITS)
+#define HISTOGRAM_BUCKET_COUNT ((64 - HISTOGRAM_SUB_BUCKET_BITS + 1) * HISTOGRAM_SUB_BUCKET_COUNT)
+
+typedef struct {
+    // Written by the recording thread only with relaxed atomics, never locked.
+    atomic_ullong counts[HISTOGRAM_BUCKET_COUNT];
+    atomic_ullong sum;
+    atomic_ullong min;
+    atomic_ullong max;
+
+    // Owned by the snapshot reader.
+    unsigned long long last_counts[HISTOGRAM_BUCKET_COUNT];
+    unsigned long long last_sum;
+} histogram;
+
+typedef struct {
+    unsigned long long count;
+    unsigned long long min;
+    unsigned long long p50;
+    unsigned long long p99;
+    unsigned long long max;
+    double mean;
+} histogram_snapshot;
+
+void histogram_init(histogram *h);
+void histogram_record(histogram *h, unsigned long long value);
+
+// Stats of values recorded since the previous snapshot.
+// Safe to call from another thread while the owner keeps recording.
+void histogram_take_snapshot(histogram *h, histogram_snapshot *out);
+
+#endif
@@ -1,4 +1,5 @@
 #include <stdlib.h>
+#include <stdatomic.h>
 
 #include <obs.h>
 
@@ -8,22 +9,75 @@
 #include "ogl-loader.h"
 #include "render.h"
 #include "clock.h"
+#include "gpu-measure.h"
+#include "trace.h"
+#include "config.h"
+
+typedef struct {
+    projection_config *config;
+    unsigned long long generation;
+} config_snapshot;
 
 static int run = 0;
-static int waiting = 0;
+static int started = 0;
 
 static thrd_t thread_id;
 static mtx_t thread_mutex;
 static cnd_t thread_cond;
 
+// Latest snapshot not yet adopted by the render thread.
+// Publishers and the render thread only ever exchange it, so each snapshot
+// is taken by exactly one of them.
+static _Atomic(config_snapshot*) published_snapshot = NULL;
+static atomic_ullong next_generation = 0;
+static atomic_int pending_render_resize = 0;
+// Display windows the UI thread waits to be released, guarded by thread_mutex
+static atomic_uint pending_detach_mask = 0;
+// Set while the UI thread recreates detached windows, guarded by thread_mutex
+static int displays_parked = 0;
+
+// Owned by the render thread
 static projection_config *config;
-static int pending_config_reload;
+static unsigned long long config_generation;
+
+static void free_config_snapshot(config_snapshot *snapshot) {
+    free_projection_config(snapshot->config);
+    free(snapshot);
+}
+
+static projection_config* loop_take_config() {
+    config_snapshot *snapshot = atomic_exchange(&published_snapshot, NULL);
+
+    if (snapshot == NULL) {
+        return NULL;
+    }
+
+    projection_config *result = snapshot->config;
+    config_generation = snapshot->generation;
+
+    free(snapshot);
+
+    log_debug("Adopting config generation %llu\n", config_generation);
+
+    return result;
+}
+
+static void loop_replace_config(projection_config *next) {
+    if (config != next) {
+        free_projection_config(config);
+    }
+
+    config = next;
+}
 
 int loop(void *_) {
     time_measure* tm0 = create_measure("Renders Update Assets");
     time_measure* tm1 = create_measure("Renders Cycle");
     time_measure* tm2 = create_measure("Monitors Cycle");
     time_measure* tm3 = create_measure("Monitors Flip");
+    time_measure* tm4 = create_measure("Monitors Config Hot Reload");
+
+    trace_set_thread_name("Projector Render Loop");
 
     render_output *output;
 
@@ -32,37 +86,92 @@ int loop(void *_) {
 
     log_debug("Monitors ready to connect to renders.\n");
 
+    // Config whose virtual screens are being built by the resource loader
+    projection_config *loading_config = NULL;
+
+    loop_replace_config(loop_take_config());
+
+    atomic_store(&pending_render_resize, 0);
+
     monitors_start(config);
 
     log_debug("Monitors started.\n");
 
-    pending_config_reload = 0;
-
     monitors_set_share_context();
     renders_init();
 
+    gpu_measure* gm0 = create_gpu_measure("Renders Update Assets");
+    gpu_measure* gm1 = create_gpu_measure("Renders Cycle");
+
     log_debug("Main loop initalized.\n");
 
+    mtx_lock(&thread_mutex);
+    started = 1;
+    cnd_signal(&thread_cond);
+    mtx_unlock(&thread_mutex);
+
     while (run) {
-        mtx_lock(&thread_mutex);
+        // Frame boundary: nothing from the previous config is in use anymore
+        if (loading_config && monitors_config_reload_ready()) {
+            begin_measure(tm4);
+            monitors_config_reload_commit();
+            end_measure(tm4);
+
+            loop_replace_config(loading_config);
+            loading_config = NULL;
+        }
 
-        if (pending_config_reload) {
-            monitors_config_hot_reload(config);
-            pending_config_reload = 0;
+        // Never while a reload is in flight, the loader reads the display windows
+        if (loading_config == NULL && atomic_load(&pending_detach_mask)) {
+            mtx_lock(&thread_mutex);
+            monitors_detach_windows(atomic_load(&pending_detach_mask));
+            atomic_store(&pending_detach_mask, 0);
+            displays_parked = 1;
+            cnd_broadcast(&thread_cond);
+
+            // The UI thread rewrites the display windows, nothing may walk them meanwhile
+            while (displays_parked) {
+                cnd_wait(&thread_cond, &thread_mutex);
+            }
+
+            mtx_unlock(&thread_mutex);
         }
 
-        if (waiting) {
-            cnd_signal(&thread_cond);
+        if (loading_config == NULL) {
+            projection_config *next = loop_take_config();
+
+            if (next) {
+                monitors_attach_windows(next, config_generation);
+            }
+
+            if (next && monitors_config_reload_async(next)) {
+                loading_config = next;
+            } else if (next) {
+                begin_measure(tm4);
+                monitors_config_hot_reload(next);
+                end_measure(tm4);
+
+                loop_replace_config(next);
+            }
         }
 
-        mtx_unlock(&thread_mutex);
+        // Same as detaching, the flag stays set until the reload is committed
+        if (loading_config == NULL && atomic_exchange(&pending_render_resize, 0)) {
+            monitors_config_hot_reload(config);
+        }
 
+        GL_STATS_STAGE(GL_STATS_STAGE_UPLOAD);
         begin_measure(tm0);
+        begin_gpu_measure(gm0);
         renders_update_assets();
+        end_gpu_measure(gm0);
         end_measure(tm0);
 
+        GL_STATS_STAGE(GL_STATS_STAGE_RENDER);
         begin_measure(tm1);
+        begin_gpu_measure(gm1);
         renders_cycle();
+        end_gpu_measure(gm1);
         end_measure(tm1);
 
         begin_measure(tm2);
@@ -77,11 +186,26 @@ int loop(void *_) {
         renders_flush_buffers();
 
         register_monitor_frame();
+        GL_STATS_END_FRAME();
     }
 
+    monitors_set_share_context();
+    destroy_gpu_measure(gm0);
+    destroy_gpu_measure(gm1);
+
+    destroy_measure(tm0);
+    destroy_measure(tm1);
+    destroy_measure(tm2);
+    destroy_measure(tm3);
+    destroy_measure(tm4);
+
     log_debug("monitors_stop\n");
     monitors_stop();
 
+    if (loading_config != config) {
+        free_projection_config(loading_config);
+    }
+
     log_debug("renders_terminate.\n");
     renders_terminate();
 
@@ -94,19 +218,62 @@ int loop(void *_) {
 }
 
 void main_loop_schedule_config_reload(projection_config *in_config) {
-    if (run) {
-        mtx_lock(&thread_mutex);
-        waiting = 1;
+    config_snapshot *snapshot = (config_snapshot*) malloc(sizeof(config_snapshot));
+
+    snapshot->config = in_config;
+    snapshot->generation = atomic_fetch_add(&next_generation, 1) + 1;
+
+    config_snapshot *superseded = atomic_exchange(&published_snapshot, snapshot);
+
+    // Never seen by the render thread
+    if (superseded) {
+        if (superseded->config == in_config) {
+            free(superseded);
+        } else {
+            free_config_snapshot(superseded);
+        }
+    }
+
+    trace_instant_event("Schedule Config Reload");
+}
+
+unsigned long long main_loop_next_config_generation() {
+    return atomic_load(&next_generation) + 1;
+}
+
+void main_loop_detach_displays(unsigned int display_mask) {
+    if (display_mask == 0) {
+        return;
     }
 
-    config = in_config;
-    pending_config_reload = 1;
+    unsigned long long begin_ns = get_time_ns();
+
+    mtx_lock(&thread_mutex);
 
-    if (run) {
+    atomic_store(&pending_detach_mask, display_mask);
+
+    while (atomic_load(&pending_detach_mask)) {
         cnd_wait(&thread_cond, &thread_mutex);
-        waiting = 0;
-        mtx_unlock(&thread_mutex);
     }
+
+    mtx_unlock(&thread_mutex);
+
+    log_debug("Displays 0x%x detached after %.3fms\n", display_mask, (get_time_ns() - begin_ns) / 1.0e6);
+}
+
+void main_loop_resume_displays() {
+    mtx_lock(&thread_mutex);
+
+    if (displays_parked) {
+        displays_parked = 0;
+        cnd_broadcast(&thread_cond);
+    }
+
+    mtx_unlock(&thread_mutex);
+}
+
+void main_loop_schedule_render_resize() {
+    atomic_store(&pending_render_resize, 1);
 }
 
 void main_loop_start() {
@@ -114,13 +281,18 @@ void main_loop_start() {
     cnd_init(&thread_cond);
 
     run = 1;
+    started = 0;
+    displays_parked = 0;
+    atomic_store(&pending_detach_mask, 0);
 
     thrd_create(&thread_id, loop, NULL);
 
     mtx_lock(&thread_mutex);
-    waiting = 1;
-    cnd_wait(&thread_cond, &thread_mutex);
-    waiting = 0;
+
+    while (!started) {
+        cnd_wait(&thread_cond, &thread_mutex);
+    }
+
     mtx_unlock(&thread_mutex);
 
     log_debug("main loop start done.\n");
@@ -135,5 +307,16 @@ void main_loop_terminate() {
     mtx_destroy(&thread_mutex);
     log_debug("join main loop done.\n");
 
+    config_snapshot *snapshot = atomic_exchange(&published_snapshot, NULL);
+
+    if (snapshot) {
+        if (snapshot->config == config) {
+            free(snapshot);
+        } else {
+            free_config_snapshot(snapshot);
+        }
+    }
+
+    free_projection_config(config);
     config = NULL;
 }
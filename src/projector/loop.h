@@ -6,7 +6,25 @@
 #define _LOOP_H_
 
 void main_loop_start();
+
+// Never blocks. The render thread adopts the config at its next frame and
+// owns it from now on: it is freed once superseded or on terminate.
 void main_loop_schedule_config_reload(projection_config *config);
+
+// Generation the next scheduled config will get. Only the UI thread schedules configs.
+unsigned long long main_loop_next_config_generation();
+
+// Blocks until the render thread stopped drawing to the display windows in
+// display_mask, so they can be destroyed. The render thread then stays parked,
+// off every display window, until main_loop_resume_displays.
+void main_loop_detach_displays(unsigned int display_mask);
+
+// Lets the render thread run again once the detached windows are recreated
+void main_loop_resume_displays();
+
+// Rebuild virtual screens with the current config, e.g. after the OBS output size changed
+void main_loop_schedule_render_resize();
+
 void main_loop_terminate();
 
 #endif
@@ -9,9 +9,13 @@
 #include <dwmapi.h>
 #endif
 
+#include "clock.h"
+#include "config.h"
+#include "custom-math.h"
 #include "debug.h"
 #include "ogl-loader.h"
 #include "monitor.h"
+#include "resource-loader.h"
 #include "virtual-screen.h"
 
 static int monitors_count;
@@ -23,6 +27,22 @@ static int display_window_count = 0;
 static display_window display_windows[MAX_DISPLAYS];
 
 static GLFWwindow *gl_share_context = NULL;
+static GLFWwindow *loader_window = NULL;
+
+// Virtual screens built by the resource loader, waiting to be attached.
+// Filled by the render thread before the job is submitted, the loader only
+// reads it and fills virtual_screen_data.
+typedef struct {
+    config_display *config;
+    int rebuild_all;
+    int *build;
+    int *changes;
+    void **virtual_screen_data;
+} display_window_reload;
+
+static display_window_reload pending_reloads[MAX_DISPLAYS];
+static int pending_reload_count = 0;
+static projection_config *pending_reload_config = NULL;
 
 static render_output *render_output_config;
 
@@ -180,12 +200,18 @@ void monitor_set_context_if_need(GLFWwindow* context)
     {
         glfwMakeContextCurrent(context);
     }
+
+    ogl_state_make_current(context);
 }
 
 GLFWwindow* monitors_get_shared_window() {
     return gl_share_context;
 }
 
+GLFWwindow* monitors_get_loader_window() {
+    return loader_window;
+}
+
 void monitors_set_share_context() {
     if (gl_share_context) {
         monitor_set_context_if_need(gl_share_context);
@@ -202,60 +228,113 @@ void destroy_display_window(display_window *dw) {
 }
 
 void monitors_destroy_windows() {
-    gl_share_context = NULL;
-
     for (int i=0; i<display_window_count; i++) {
         display_window *dw = &display_windows[i];
 
         destroy_display_window(dw);
 
-        if (dw->virtual_screen_data) {
-            free(dw->virtual_screen_data);
-        }
+        // Owned by the config arena
+        dw->virtual_screen_data = NULL;
     }
 
     display_window_count = 0;
+
+    if (loader_window) {
+        glfwDestroyWindow(loader_window);
+        loader_window = NULL;
+    }
+
+    if (gl_share_context) {
+        glfwDestroyWindow(gl_share_context);
+        gl_share_context = NULL;
+    }
+}
+
+void internal_monitors_create_display_window(projection_config *config, int index) {
+    config_display *dsp = &config->display[index];
+    display_window *dw = &display_windows[index];
+
+    dw->active = 0;
+    atomic_store(&dw->attach_generation, 0);
+
+    if (!dsp->projection_enabled) {
+        dw->config = NULL;
+        dw->display_index = -1;
+        return;
+    }
+
+    monitor* m = internal_monitors_get_display_monitor(dsp);
+
+    if (m) {
+        create_window(m, dw);
+    } else {
+        create_non_fs_window(&monitors[0], dw, dsp);
+    }
+
+    dw->config = dsp;
+    dw->display_index = index;
 }
 
 void monitors_create_windows(projection_config *config) {
-    for (int i=0; i<config->count_display; i++) {
-        if (i >= MAX_DISPLAYS) {
-            log_debug("Maximum number of displays exceeded. Some displays won't be created");
-            break;
-        }
+    // Display windows come and go with config changes, so shared objects
+    // live in a hidden window that stays until shutdown
+    glfwDefaultWindowHints();
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    glfwWindowHint(GLFW_SAMPLES, 0);
 
-        int found = 0;
+    gl_share_context = glfwCreateWindow(1, 1, "Projector Share Window", NULL, NULL);
+    loader_window = glfwCreateWindow(1, 1, "Projector Loader Window", NULL, gl_share_context);
 
-        config_display *dsp = &config->display[i];
-        display_window *dw = &display_windows[i];
-        monitor* m = internal_monitors_get_display_monitor(dsp);
+    if (config->count_display > MAX_DISPLAYS) {
+        log_debug("Maximum number of displays exceeded. Some displays won't be created");
+    }
 
-        if (m && dsp->projection_enabled) {
-            found = 1;
+    display_window_count = MIN(config->count_display, MAX_DISPLAYS);
 
-            create_window(m, dw);
+    for (int i=0; i<display_window_count; i++) {
+        internal_monitors_create_display_window(config, i);
+    }
+}
+
+unsigned int monitors_windows_to_recreate(projection_config *current, projection_config *next) {
+    unsigned int display_mask = 0;
+    int count = MIN(MAX(current->count_display, next->count_display), MAX_DISPLAYS);
+
+    for (int i=0; i<count; i++) {
+        if (i >= current->count_display || i >= next->count_display ||
+            config_display_requires_restart(&current->display[i], &next->display[i])) {
+            display_mask |= 1u << i;
         }
+    }
 
-        if (!found) {
-            if (dsp->projection_enabled) {
-                create_non_fs_window(&monitors[0], dw, dsp);
-            } else {
-                dw->config = NULL;
-                dw->display_index = -1;
-                continue;
-            }
+    return display_mask;
+}
+
+void monitors_recreate_windows(projection_config *config, unsigned int display_mask, unsigned long long attach_generation) {
+    int count = MIN(config->count_display, MAX_DISPLAYS);
+
+    for (int i=0; i<MAX_DISPLAYS; i++) {
+        if ((display_mask & (1u << i)) == 0) {
+            continue;
         }
 
-        dw->config = dsp;
-        dw->display_index = i;
-        dw->active = 0;
+        display_window *dw = &display_windows[i];
 
-        if (gl_share_context == NULL) {
-            gl_share_context = dw->window;
+        destroy_display_window(dw);
+
+        if (i < count) {
+            internal_monitors_create_display_window(config, i);
+
+            if (dw->window) {
+                atomic_store(&dw->attach_generation, attach_generation);
+            }
+        } else {
+            dw->config = NULL;
+            dw->display_index = -1;
         }
     }
 
-    display_window_count = config->count_display;
+    display_window_count = count;
 }
 
 void monitors_get_default_projection_bounds(config_bounds *in) {
@@ -309,14 +388,13 @@ void internal_monitors_reload_vs(projection_config* config, display_window* dw)
             virtual_screen_monitor_stop(dw->virtual_screen_data[j]);
         }
 
-        free(dw->virtual_screen_data);
         dw->virtual_screen_data = NULL;
     }
 
     config_display* dsp = &config->display[dw->display_index];
 
     dw->config = dsp;
-    dw->virtual_screen_data = (void**)calloc(dsp->count_virtual_screen, sizeof(void*));
+    dw->virtual_screen_data = (void**) config_alloc(config, dsp->count_virtual_screen * sizeof(void*));
 
     for (int k = 0; k < dw->config->count_virtual_screen; k++) {
         config_virtual_screen* config_vs = &dw->config->virtual_screens[k];
@@ -324,54 +402,343 @@ void internal_monitors_reload_vs(projection_config* config, display_window* dw)
 
         monitors_set_share_context();
         virtual_screen_shared_start(dsp, render, config_vs, &dw->virtual_screen_data[k]);
+        virtual_screen_shared_create_measures(dw->virtual_screen_data[k], dw->display_index, k);
 
         monitor_set_context_if_need(dw->window);
         virtual_screen_monitor_start(dsp, render, config_vs, dw->virtual_screen_data[k]);
     }
 }
 
+void internal_monitors_update_vs(projection_config* config, display_window* dw) {
+    config_display* dsp = &config->display[dw->display_index];
+
+    if (dw->virtual_screen_data == NULL || dw->config->count_virtual_screen != dsp->count_virtual_screen) {
+        log_debug("Display %i virtual screens count changed, rebuilding all\n", dw->display_index);
+        internal_monitors_reload_vs(config, dw);
+        return;
+    }
+
+    // The array belongs to the previous config arena, move it to the new one
+    void **virtual_screen_data = (void**) config_alloc(config, dsp->count_virtual_screen * sizeof(void*));
+    memcpy(virtual_screen_data, dw->virtual_screen_data, dsp->count_virtual_screen * sizeof(void*));
+    dw->virtual_screen_data = virtual_screen_data;
+
+    for (int k = 0; k < dsp->count_virtual_screen; k++) {
+        unsigned long long begin_ns = get_time_ns();
+
+        config_virtual_screen* config_vs = &dsp->virtual_screens[k];
+        render_output* render = get_render_output_config(config_vs);
+        void* vs_data = dw->virtual_screen_data[k];
+
+        // dw->config still points to the previous config here
+        int changes = config_virtual_screen_changes(&dw->config->virtual_screens[k], config_vs);
+
+        monitors_set_share_context();
+        virtual_screen_shared_update(dsp, render, config_vs, vs_data, changes);
+
+        if (changes) {
+            monitor_set_context_if_need(dw->window);
+
+            if (virtual_screen_monitor_can_patch(&dw->config->virtual_screens[k], config_vs, changes)) {
+                virtual_screen_monitor_patch(&dw->config->virtual_screens[k], config_vs, vs_data);
+            } else {
+                virtual_screen_monitor_update(dsp, render, config_vs, vs_data, changes);
+            }
+
+            log_debug(
+                "Display %i VS %i reloaded (changes 0x%x) in %.3fms\n",
+                dw->display_index, k, changes, (get_time_ns() - begin_ns) / 1.0e6);
+        }
+    }
+
+    dw->config = dsp;
+}
+
 void monitors_config_hot_reload(projection_config *config) {
+    unsigned long long begin_ns = get_time_ns();
+
     for (int i=0; i<display_window_count; i++) {
         display_window *dw = &display_windows[i];
 
         if (dw->active) {
-            internal_monitors_reload_vs(config, dw);
+            internal_monitors_update_vs(config, dw);
         }
     }
+
+    log_debug("Config hot reload done in %.3fms\n", (get_time_ns() - begin_ns) / 1.0e6);
 }
 
-void monitors_load_renders(render_output* data) {
-    render_output_config = data;
+// Resource loader thread. Only reads the reloads prepared by the render thread.
+void internal_monitors_build_reload(void *data) {
+    for (int i = 0; i < pending_reload_count; i++) {
+        display_window_reload *reload = &pending_reloads[i];
+        config_display *dsp = reload->config;
+
+        if (dsp == NULL) {
+            continue;
+        }
+
+        for (int k = 0; k < dsp->count_virtual_screen; k++) {
+            config_virtual_screen *config_vs = &dsp->virtual_screens[k];
+
+            if (!reload->build[k]) {
+                continue;
+            }
+
+            virtual_screen_shared_build(dsp, get_render_output_config(config_vs), config_vs, &reload->virtual_screen_data[k]);
+            virtual_screen_monitor_build(dsp, config_vs, reload->virtual_screen_data[k]);
+        }
+    }
 }
 
-void monitors_start(projection_config* config) {
-    int first = 1;
+// Render thread. Diffs the display windows against the config and allocates
+// from its arena, so the loader never touches either.
+void internal_monitors_prepare_reload(projection_config *config) {
+    pending_reload_count = display_window_count;
 
     for (int i = 0; i < display_window_count; i++) {
-        display_window* dw = &display_windows[i];
+        display_window *dw = &display_windows[i];
+        display_window_reload *reload = &pending_reloads[i];
 
-        if (dw->window) {
-            monitor_set_context_if_need(dw->window);
+        memset(reload, 0, sizeof(display_window_reload));
 
-            if (first)
-            {
-                glfwSwapInterval(1);
-                first = 0;
+        if (!dw->active) {
+            continue;
+        }
+
+        config_display *dsp = &config->display[dw->display_index];
+
+        reload->config = dsp;
+        reload->rebuild_all = dw->virtual_screen_data == NULL || dw->config->count_virtual_screen != dsp->count_virtual_screen;
+        reload->build = (int*) config_alloc(config, dsp->count_virtual_screen * sizeof(int));
+        reload->changes = (int*) config_alloc(config, dsp->count_virtual_screen * sizeof(int));
+        reload->virtual_screen_data = (void**) config_alloc(config, dsp->count_virtual_screen * sizeof(void*));
+
+        for (int k = 0; k < dsp->count_virtual_screen; k++) {
+            config_virtual_screen *config_vs = &dsp->virtual_screens[k];
+
+            if (reload->rebuild_all) {
+                reload->build[k] = 1;
+                continue;
             }
-            else
-            {
-                glfwSwapInterval(0);
+
+            reload->changes[k] = config_virtual_screen_changes(&dw->config->virtual_screens[k], config_vs);
+
+            // Blend curves are updated in place, so are meshes keeping their counts
+            int rebuild = reload->changes[k] & ~CONFIG_VS_CHANGE_BLEND_CURVE;
+
+            if (virtual_screen_monitor_can_patch(&dw->config->virtual_screens[k], config_vs, reload->changes[k])) {
+                rebuild &= ~CONFIG_VS_CHANGE_MESH;
+            }
+
+            reload->build[k] = rebuild != 0;
+        }
+    }
+}
+
+int monitors_config_reload_async(projection_config *config) {
+    if (pending_reload_config || !resource_loader_running()) {
+        return 0;
+    }
+
+    internal_monitors_prepare_reload(config);
+
+    if (!resource_loader_submit(internal_monitors_build_reload, config)) {
+        pending_reload_count = 0;
+        return 0;
+    }
+
+    pending_reload_config = config;
+
+    return 1;
+}
+
+int monitors_config_reload_ready() {
+    return pending_reload_config && resource_loader_poll();
+}
+
+void internal_monitors_stop_vs(display_window *dw, void *vs_data) {
+    monitors_set_share_context();
+    virtual_screen_shared_stop(vs_data);
+
+    monitor_set_context_if_need(dw->window);
+    virtual_screen_monitor_stop(vs_data);
+}
+
+void internal_monitors_attach_vs(display_window *dw, config_virtual_screen *config_vs, void *vs_data, int index) {
+    monitors_set_share_context();
+    virtual_screen_shared_attach(config_vs, vs_data);
+    virtual_screen_shared_create_measures(vs_data, dw->display_index, index);
+
+    monitor_set_context_if_need(dw->window);
+    virtual_screen_monitor_attach(vs_data);
+}
+
+// The arrays are owned by the reloaded config arena
+void internal_monitors_free_reload(display_window_reload *reload) {
+    memset(reload, 0, sizeof(display_window_reload));
+}
+
+void monitors_config_reload_commit() {
+    unsigned long long begin_ns = get_time_ns();
+
+    for (int i = 0; i < display_window_count; i++) {
+        display_window *dw = &display_windows[i];
+        display_window_reload *reload = &pending_reloads[i];
+
+        if (!dw->active || reload->config == NULL) {
+            continue;
+        }
+
+        config_display *dsp = reload->config;
+
+        if (reload->rebuild_all) {
+            if (dw->virtual_screen_data) {
+                for (int j = 0; j < dw->config->count_virtual_screen; j++) {
+                    internal_monitors_stop_vs(dw, dw->virtual_screen_data[j]);
+                }
+            }
+
+            dw->virtual_screen_data = reload->virtual_screen_data;
+
+            for (int k = 0; k < dsp->count_virtual_screen; k++) {
+                internal_monitors_attach_vs(dw, &dsp->virtual_screens[k], dw->virtual_screen_data[k], k);
+            }
+        } else {
+            for (int k = 0; k < dsp->count_virtual_screen; k++) {
+                config_virtual_screen *config_vs = &dsp->virtual_screens[k];
+                void *vs_data = reload->virtual_screen_data[k];
+
+                if (vs_data) {
+                    internal_monitors_stop_vs(dw, dw->virtual_screen_data[k]);
+                    internal_monitors_attach_vs(dw, config_vs, vs_data, k);
+                } else {
+                    reload->virtual_screen_data[k] = dw->virtual_screen_data[k];
+
+                    monitors_set_share_context();
+                    virtual_screen_shared_update(dsp, get_render_output_config(config_vs), config_vs, dw->virtual_screen_data[k], reload->changes[k]);
+
+                    // dw->config still points to the previous config here
+                    if (reload->changes[k] & CONFIG_VS_CHANGE_MESH) {
+                        monitor_set_context_if_need(dw->window);
+                        virtual_screen_monitor_patch(&dw->config->virtual_screens[k], config_vs, dw->virtual_screen_data[k]);
+                    }
+                }
+            }
+
+            // The previous array belongs to the old config arena
+            dw->virtual_screen_data = reload->virtual_screen_data;
+        }
+
+        dw->config = dsp;
+
+        internal_monitors_free_reload(reload);
+    }
+
+    pending_reload_config = NULL;
+
+    log_debug("Config reload swapped in after %.3fms\n", (get_time_ns() - begin_ns) / 1.0e6);
+}
+
+// Drops a reload still in flight. The resource loader must be stopped.
+void internal_monitors_discard_reload() {
+    if (pending_reload_config == NULL) {
+        return;
+    }
+
+    monitors_set_share_context();
+
+    for (int i = 0; i < pending_reload_count; i++) {
+        display_window_reload *reload = &pending_reloads[i];
+
+        if (reload->config == NULL) {
+            continue;
+        }
+
+        for (int k = 0; k < reload->config->count_virtual_screen; k++) {
+            if (reload->virtual_screen_data[k]) {
+                virtual_screen_shared_stop(reload->virtual_screen_data[k]);
+                virtual_screen_monitor_stop(reload->virtual_screen_data[k]);
             }
+        }
+
+        internal_monitors_free_reload(reload);
+    }
+
+    pending_reload_config = NULL;
+}
+
+void monitors_load_renders(render_output* data) {
+    render_output_config = data;
+}
+
+display_window* internal_monitors_get_vsync_window() {
+    for (int i = 0; i < display_window_count; i++) {
+        display_window* dw = &display_windows[i];
+
+        if (dw->active && dw->swap_interval) {
+            return dw;
+        }
+    }
+
+    return NULL;
+}
+
+void internal_monitors_start_window(projection_config* config, display_window* dw) {
+    monitor_set_context_if_need(dw->window);
+
+    // Only one window waits for vsync, the others would stall the loop
+    dw->swap_interval = internal_monitors_get_vsync_window() == NULL;
+    glfwSwapInterval(dw->swap_interval);
 
 #ifdef _GLEW_ENABLED_
-            glewInit();
+    glewInit();
 #endif
-            
-            glEnable(GL_BLEND);
+
+    glEnable(GL_BLEND);
+
+    char name[64];
+    snprintf(name, sizeof(name), "Display %i Warp", dw->display_index);
+    dw->warp_measure = create_gpu_measure(name);
+
+    snprintf(name, sizeof(name), "Display %i Swap", dw->display_index);
+    dw->swap_measure = create_measure(name);
+
+    internal_monitors_reload_vs(config, dw);
+    dw->active = 1;
+}
+
+void internal_monitors_stop_window(display_window* dw) {
+    dw->active = 0;
+
+    if (dw->virtual_screen_data) {
+        for (int j = 0; j < dw->config->count_virtual_screen; j++) {
+            internal_monitors_stop_vs(dw, dw->virtual_screen_data[j]);
+            dw->virtual_screen_data[j] = NULL;
         }
+
+        dw->virtual_screen_data = NULL;
     }
 
+    monitor_set_context_if_need(dw->window);
+    destroy_gpu_measure(dw->warp_measure);
+    dw->warp_measure = NULL;
+
+    destroy_measure(dw->swap_measure);
+    dw->swap_measure = NULL;
+
+    ogl_state_forget(dw->window);
+}
+
+void monitors_start(projection_config* config) {
     monitors_set_share_context();
+
+#ifdef _GLEW_ENABLED_
+    glewInit();
+#endif
+
+    glEnable(GL_BLEND);
+
     virtual_screen_shared_initialize();
     virtual_screen_monitor_initialize();
 
@@ -379,44 +746,100 @@ void monitors_start(projection_config* config) {
         display_window* dw = &display_windows[i];
 
         if (dw->window) {
-            internal_monitors_reload_vs(config, dw);
-            dw->active = 1;
+            internal_monitors_start_window(config, dw);
         }
     }
+
+    resource_loader_start(loader_window);
 }
 
-void monitors_stop() {
+void monitors_attach_windows(projection_config* config, unsigned long long generation) {
     for (int i = 0; i < display_window_count; i++) {
         display_window* dw = &display_windows[i];
+        unsigned long long attach_generation = atomic_load(&dw->attach_generation);
 
-        if (dw->active) {
-            dw->active = 0;
+        // Windows created for a config newer than this one wait for it
+        if (dw->active || attach_generation == 0 || attach_generation > generation) {
+            continue;
+        }
 
-            if (dw->virtual_screen_data) {
-                for (int j = 0; j < dw->config->count_virtual_screen; j++) {
-                    monitors_set_share_context();
-                    virtual_screen_shared_stop(dw->virtual_screen_data[j]);
+        if (dw->window && dw->display_index < config->count_display) {
+            unsigned long long begin_ns = get_time_ns();
 
-                    monitor_set_context_if_need(dw->window);
-                    virtual_screen_monitor_stop(dw->virtual_screen_data[j]);
+            internal_monitors_start_window(config, dw);
 
-                    dw->virtual_screen_data[j] = NULL;
-                }
+            log_debug("Display %i attached in %.3fms\n", dw->display_index, (get_time_ns() - begin_ns) / 1.0e6);
+        }
 
-                free(dw->virtual_screen_data);
-                dw->virtual_screen_data = NULL;
+        atomic_store(&dw->attach_generation, 0);
+    }
+
+    monitors_set_share_context();
+}
+
+void monitors_detach_windows(unsigned int display_mask) {
+    for (int i = 0; i < display_window_count; i++) {
+        display_window* dw = &display_windows[i];
+
+        if ((display_mask & (1u << i)) == 0) {
+            continue;
+        }
+
+        atomic_store(&dw->attach_generation, 0);
+
+        if (!dw->active) {
+            continue;
+        }
+
+        internal_monitors_stop_window(dw);
+
+        log_debug("Display %i detached\n", dw->display_index);
+
+        if (dw->swap_interval) {
+            dw->swap_interval = 0;
+
+            for (int j = 0; j < display_window_count; j++) {
+                display_window* other = &display_windows[j];
+
+                if (other->active) {
+                    monitor_set_context_if_need(other->window);
+                    glfwSwapInterval(1);
+                    other->swap_interval = 1;
+                    break;
+                }
             }
         }
     }
+
+    // The UI thread destroys detached windows, their contexts can't stay current here
+    monitors_set_share_context();
+}
+
+void monitors_stop() {
+    monitors_set_share_context();
+    resource_loader_stop();
+    internal_monitors_discard_reload();
+
+    for (int i = 0; i < display_window_count; i++) {
+        display_window* dw = &display_windows[i];
+
+        if (dw->active) {
+            internal_monitors_stop_window(dw);
+        }
+    }
 }
 
 void monitors_terminate() {
     monitors_set_share_context();
     virtual_screen_shared_shutdown();
     virtual_screen_monitor_shutdown();
+
+    ogl_state_forget(gl_share_context);
 }
 
 void monitors_cycle() {
+    GL_STATS_STAGE(GL_STATS_STAGE_VIRTUAL_SCREEN);
+
     for (int i = 0; i < display_window_count; i++) {
         display_window *dw = &display_windows[i];
 
@@ -428,44 +851,50 @@ void monitors_cycle() {
         }
     }
 
+    GL_STATS_STAGE(GL_STATS_STAGE_MONITOR);
+
     for (int i=0; i<display_window_count; i++) {
         display_window *dw = &display_windows[i];
 
         if (dw->active) {
             monitor_set_context_if_need(dw->window);
-            glEnable(GL_TEXTURE_2D);
 
             int width, height;
             glfwGetFramebufferSize(dw->window, &width, &height);
-            glViewport(0, 0, width, height);
+            ogl_viewport(0, 0, width, height);
 
             glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
             glClear(GL_COLOR_BUFFER_BIT);
 
-            glPushMatrix();
-            glLoadIdentity();
+            begin_gpu_measure(dw->warp_measure);
 
-            glOrtho(0.0, dw->config->monitor_bounds.w, 0.0, dw->config->monitor_bounds.h, 0.0, 1.0);
+            // After the clear, each virtual screen sets its own box
+            glEnable(GL_SCISSOR_TEST);
 
             for (int j=0; j < dw->config->count_virtual_screen; j++) {
                 void *vs_data = dw->virtual_screen_data[j];
-                virtual_screen_monitor_print(&dw->config->virtual_screens[j], vs_data);
+                virtual_screen_monitor_print(&dw->config->virtual_screens[j], vs_data, width, height);
             }
 
-            glPopMatrix();
-   
-            glDisable(GL_TEXTURE_2D);
+            glDisable(GL_SCISSOR_TEST);
+
+            end_gpu_measure(dw->warp_measure);
         }
     }
 }
 
 void monitors_flip() {
+    GL_STATS_STAGE(GL_STATS_STAGE_OTHER);
+
     for (int i = 0; i < display_window_count; i++) {
         display_window *dw = &display_windows[i];
 
         if (dw->active) {
             monitor_set_context_if_need(dw->window);
+
+            begin_measure(dw->swap_measure);
             glfwSwapBuffers(dw->window);
+            end_measure(dw->swap_measure);
         }
     }
 }
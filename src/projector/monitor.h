@@ -1,6 +1,10 @@
+#include <stdatomic.h>
+
 #include "ogl-loader.h"
 #include "config-structs.h"
 #include "render.h"
+#include "gpu-measure.h"
+#include "debug.h"
 
 #ifndef _MONITOR_H_
 #define _MONITOR_H_
@@ -20,6 +24,11 @@ typedef struct {
     void **virtual_screen_data;
     int active;
     int refresh_rate;
+    int swap_interval;
+    // Config generation the render thread attaches this window with, 0 if none
+    atomic_ullong attach_generation;
+    gpu_measure *warp_measure;
+    time_measure *swap_measure;
 } display_window;
 
 typedef struct {
@@ -27,6 +36,7 @@ typedef struct {
 } monitor_info;
 
 GLFWwindow* monitors_get_shared_window();
+GLFWwindow* monitors_get_loader_window();
 void monitors_set_share_context();
 
 void monitors_reload();
@@ -35,8 +45,26 @@ void monitors_adjust_windows(projection_config* config);
 void monitors_create_windows(projection_config *config);
 void monitors_destroy_windows();
 
+// Per display restart, used when displays change while the render loop keeps running.
+// Returns a bit mask of display indexes whose window must be recreated.
+unsigned int monitors_windows_to_recreate(projection_config *current, projection_config *next);
+// UI thread, after the render thread detached the windows in display_mask
+void monitors_recreate_windows(projection_config *config, unsigned int display_mask, unsigned long long attach_generation);
+// Render thread, at a frame boundary
+void monitors_detach_windows(unsigned int display_mask);
+void monitors_attach_windows(projection_config* config, unsigned long long generation);
+
+// Must be called before the previous config is freed, it is diffed against the new one
 void monitors_config_hot_reload(projection_config *config);
 
+// Same as monitors_config_hot_reload, but changed virtual screens are built
+// on the resource loader thread. Returns 0 if the loader is unavailable or busy.
+// Keep rendering the current config until monitors_config_reload_ready, then
+// swap with monitors_config_reload_commit.
+int monitors_config_reload_async(projection_config *config);
+int monitors_config_reload_ready();
+void monitors_config_reload_commit();
+
 void monitors_get_default_projection_bounds(config_bounds *in);
 int window_should_close();
 
@@ -1,5 +1,6 @@
 #include <string.h>
 
+#include "tinycthread.h"
 #include "ogl-loader.h"
 #include "debug.h"
 #include "shaders.h"
@@ -29,6 +30,12 @@ const char* get_shader_data(char *name) {
     if (strcmp("direct.vertex.shader", name) == 0) {
         return DIRECT_VERTEX_SHADER;
     }
+    if (strcmp("remap.fragment.shader", name) == 0) {
+        return REMAP_FRAGMENT_SHADER;
+    }
+    if (strcmp("remap.vertex.shader", name) == 0) {
+        return REMAP_VERTEX_SHADER;
+    }
     
     log_debug("Failed getting shader: %s. Source not found", name);
     return "";
@@ -82,3 +89,312 @@ void tex_set_default_params() {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 }
+
+GLuint ogl_create_vertex_array(GLuint position_buffer, GLint position_size, GLuint uv_buffer) {
+    GLuint vertex_array;
+
+    glGenVertexArrays(1, &vertex_array);
+    ogl_bind_vertex_array(vertex_array);
+
+    glBindBuffer(GL_ARRAY_BUFFER, position_buffer);
+    glVertexAttribPointer(0, position_size, GL_FLOAT, GL_FALSE, 0, 0);
+    ogl_enable_vertex_attrib_array(0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, uv_buffer);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, 0);
+    ogl_enable_vertex_attrib_array(1);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    ogl_bind_vertex_array(0);
+
+    return vertex_array;
+}
+
+GLuint ogl_create_packed_vertex_array(GLuint vertex_buffer, GLuint index_buffer) {
+    GLuint vertex_array;
+    GLsizei stride = 4 * sizeof(GLushort);
+
+    glGenVertexArrays(1, &vertex_array);
+    ogl_bind_vertex_array(vertex_array);
+
+    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+    glVertexAttribPointer(0, 2, GL_UNSIGNED_SHORT, GL_TRUE, stride, 0);
+    ogl_enable_vertex_attrib_array(0);
+
+    glVertexAttribPointer(1, 2, GL_UNSIGNED_SHORT, GL_TRUE, stride, (void*) (2 * sizeof(GLushort)));
+    ogl_enable_vertex_attrib_array(1);
+
+    // Element buffer binding is part of the vertex array state
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    ogl_bind_vertex_array(0);
+
+    return vertex_array;
+}
+
+#define OGL_STATE_MAX_CONTEXTS 16
+
+// Slots never move, other threads keep pointers to their own. A slot is free
+// when its context is NULL. Registration and the name scans below are guarded
+// by states_mutex, each thread reads its current state without it.
+static once_flag states_once = ONCE_FLAG_INIT;
+static mtx_t states_mutex;
+static ogl_state states[OGL_STATE_MAX_CONTEXTS];
+
+_Thread_local ogl_state *ogl_current_state = NULL;
+
+static void initialize_states() {
+    mtx_init(&states_mutex, 0);
+}
+
+static void ogl_state_reset(ogl_state *state) {
+    GLFWwindow *context = state->context;
+
+    memset(state, 0, sizeof(ogl_state));
+
+    state->context = context;
+    state->program = OGL_STATE_UNKNOWN;
+    state->active_texture = OGL_STATE_UNKNOWN;
+    state->vertex_array = OGL_STATE_UNKNOWN;
+    state->framebuffer = OGL_STATE_UNKNOWN;
+    state->blend_sfactor = OGL_STATE_UNKNOWN;
+    state->blend_dfactor = OGL_STATE_UNKNOWN;
+    state->blend_equation = OGL_STATE_UNKNOWN;
+    state->viewport[2] = -1;
+
+    for (int i = 0; i < OGL_STATE_TEXTURE_UNITS; i++) {
+        state->textures[i] = OGL_STATE_UNKNOWN;
+    }
+}
+
+void ogl_state_make_current(GLFWwindow *context) {
+    if (ogl_current_state && ogl_current_state->context == context) {
+        return;
+    }
+
+    ogl_current_state = NULL;
+
+    if (context == NULL) {
+        return;
+    }
+
+    call_once(&states_once, initialize_states);
+    mtx_lock(&states_mutex);
+
+    ogl_state *free_state = NULL;
+
+    for (int i = 0; i < OGL_STATE_MAX_CONTEXTS; i++) {
+        if (states[i].context == context) {
+            ogl_current_state = &states[i];
+            break;
+        }
+
+        if (free_state == NULL && states[i].context == NULL) {
+            free_state = &states[i];
+        }
+    }
+
+    if (ogl_current_state == NULL && free_state) {
+        free_state->context = context;
+        ogl_state_reset(free_state);
+
+        ogl_current_state = free_state;
+    }
+
+    mtx_unlock(&states_mutex);
+
+    if (ogl_current_state == NULL) {
+        log_debug("GL state cache full, context %p is not cached\n", (void*) context);
+    }
+}
+
+void ogl_state_forget(GLFWwindow *context) {
+    if (context == NULL) {
+        return;
+    }
+
+    if (ogl_current_state && ogl_current_state->context == context) {
+        ogl_current_state = NULL;
+    }
+
+    call_once(&states_once, initialize_states);
+    mtx_lock(&states_mutex);
+
+    for (int i = 0; i < OGL_STATE_MAX_CONTEXTS; i++) {
+        if (states[i].context == context) {
+            states[i].context = NULL;
+            break;
+        }
+    }
+
+    mtx_unlock(&states_mutex);
+}
+
+void ogl_state_invalidate() {
+    if (ogl_current_state) {
+        ogl_state_reset(ogl_current_state);
+    }
+}
+
+void ogl_delete_program(GLuint program) {
+    call_once(&states_once, initialize_states);
+    mtx_lock(&states_mutex);
+
+    for (int i = 0; i < OGL_STATE_MAX_CONTEXTS; i++) {
+        if (states[i].context && states[i].program == program) {
+            states[i].program = OGL_STATE_UNKNOWN;
+        }
+    }
+
+    mtx_unlock(&states_mutex);
+
+    glDeleteProgram(program);
+}
+
+void ogl_delete_textures(GLsizei n, const GLuint *textures) {
+    call_once(&states_once, initialize_states);
+    mtx_lock(&states_mutex);
+
+    for (int i = 0; i < OGL_STATE_MAX_CONTEXTS; i++) {
+        if (states[i].context == NULL) {
+            continue;
+        }
+
+        for (int unit = 0; unit < OGL_STATE_TEXTURE_UNITS; unit++) {
+            for (int j = 0; j < n; j++) {
+                if (states[i].textures[unit] == textures[j]) {
+                    states[i].textures[unit] = OGL_STATE_UNKNOWN;
+                }
+            }
+        }
+    }
+
+    mtx_unlock(&states_mutex);
+
+    glDeleteTextures(n, textures);
+}
+
+void ogl_delete_vertex_arrays(GLsizei n, const GLuint *vertex_arrays) {
+    call_once(&states_once, initialize_states);
+    mtx_lock(&states_mutex);
+
+    for (int i = 0; i < OGL_STATE_MAX_CONTEXTS; i++) {
+        if (states[i].context == NULL) {
+            continue;
+        }
+
+        for (int j = 0; j < n; j++) {
+            if (states[i].vertex_array == vertex_arrays[j]) {
+                states[i].vertex_array = OGL_STATE_UNKNOWN;
+            }
+        }
+    }
+
+    mtx_unlock(&states_mutex);
+
+    glDeleteVertexArrays(n, vertex_arrays);
+}
+
+void ogl_delete_framebuffers(GLsizei n, const GLuint *framebuffers) {
+    call_once(&states_once, initialize_states);
+    mtx_lock(&states_mutex);
+
+    for (int i = 0; i < OGL_STATE_MAX_CONTEXTS; i++) {
+        if (states[i].context == NULL) {
+            continue;
+        }
+
+        for (int j = 0; j < n; j++) {
+            if (states[i].framebuffer == framebuffers[j]) {
+                states[i].framebuffer = OGL_STATE_UNKNOWN;
+            }
+        }
+    }
+
+    mtx_unlock(&states_mutex);
+
+    glDeleteFramebuffers(n, framebuffers);
+}
+
+#ifdef ENABLE_GL_STATS
+
+#include "clock.h"
+
+static const char* gl_stats_stage_names[GL_STATS_STAGE_COUNT] = {
+    "Other",
+    "Upload",
+    "Render",
+    "Virtual Screen",
+    "Monitor"
+};
+
+static const char* gl_stats_counter_names[GL_STATS_COUNTER_COUNT] = {
+    "calls",
+    "draws",
+    "programs",
+    "textures",
+    "vaos",
+    "fbos",
+    "blend",
+    "uniforms",
+    "cached"
+};
+
+// Per thread, the resource loader counts its own calls. gl_stats_end_frame
+// reports the counts of the thread calling it, the render thread.
+static _Thread_local gl_stats_stage current_stage = GL_STATS_STAGE_OTHER;
+static _Thread_local unsigned long long stage_counters[GL_STATS_STAGE_COUNT][GL_STATS_COUNTER_COUNT];
+static unsigned long long frame_count = 0;
+static struct timespec last_report = {
+    .tv_nsec = 0,
+    .tv_sec = 0
+};
+
+void gl_stats_count(gl_stats_counter counter) {
+    stage_counters[current_stage][counter]++;
+
+    if (counter != GL_STATS_CALLS && counter != GL_STATS_CACHE_HITS) {
+        stage_counters[current_stage][GL_STATS_CALLS]++;
+    }
+}
+
+void gl_stats_set_stage(gl_stats_stage stage) {
+    current_stage = stage;
+}
+
+void gl_stats_end_frame() {
+    struct timespec now;
+
+    frame_count++;
+    current_stage = GL_STATS_STAGE_OTHER;
+
+    get_time(&now);
+
+    if (get_delta_time_ms(&now, &last_report) < LOG_FPS_INTERVAL_MS) {
+        return;
+    }
+
+    for (int stage = 0; stage < GL_STATS_STAGE_COUNT; stage++) {
+        char line[256];
+        int length = 0;
+
+        for (int counter = 0; counter < GL_STATS_COUNTER_COUNT; counter++) {
+            length += snprintf(
+                line + length,
+                sizeof(line) - length,
+                " %s=%.1f",
+                gl_stats_counter_names[counter],
+                stage_counters[stage][counter] / (double) frame_count);
+
+            stage_counters[stage][counter] = 0;
+        }
+
+        log_debug("GL stats per frame [%s]:%s\n", gl_stats_stage_names[stage], line);
+    }
+
+    frame_count = 0;
+    copy_time(&last_report, &now);
+}
+
+#endif
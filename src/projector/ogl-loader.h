@@ -23,4 +23,292 @@ GLuint loadShader(GLuint type, char *name);
 
 void tex_set_default_params();
 
+// VAO reading attribute 0 from position_buffer (position_size floats per vertex)
+// and attribute 1 from uv_buffer (2 floats). VAOs are not shared between contexts.
+GLuint ogl_create_vertex_array(GLuint position_buffer, GLint position_size, GLuint uv_buffer);
+
+// Interleaved x, y, u, v normalized unsigned shorts, drawn through the index buffer
+GLuint ogl_create_packed_vertex_array(GLuint vertex_buffer, GLuint index_buffer);
+
+// GL call statistics. Compiled only with ENABLE_GL_STATS,
+// otherwise GL_STATS_* expand to nothing and ogl_* wrappers are plain GL calls.
+// Counted per thread, GL_STATS_END_FRAME reports the calling thread's counts.
+
+typedef enum {
+    GL_STATS_CALLS,
+    GL_STATS_DRAWS,
+    GL_STATS_PROGRAM_BINDS,
+    GL_STATS_TEXTURE_BINDS,
+    GL_STATS_VERTEX_ARRAY_BINDS,
+    GL_STATS_FRAMEBUFFER_BINDS,
+    GL_STATS_BLEND_CHANGES,
+    GL_STATS_UNIFORMS,
+    GL_STATS_CACHE_HITS,
+    GL_STATS_COUNTER_COUNT
+} gl_stats_counter;
+
+typedef enum {
+    GL_STATS_STAGE_OTHER,
+    GL_STATS_STAGE_UPLOAD,
+    GL_STATS_STAGE_RENDER,
+    GL_STATS_STAGE_VIRTUAL_SCREEN,
+    GL_STATS_STAGE_MONITOR,
+    GL_STATS_STAGE_COUNT
+} gl_stats_stage;
+
+#ifdef ENABLE_GL_STATS
+
+void gl_stats_count(gl_stats_counter counter);
+void gl_stats_set_stage(gl_stats_stage stage);
+void gl_stats_end_frame();
+
+#define GL_STATS_COUNT(counter) gl_stats_count(counter)
+#define GL_STATS_STAGE(stage) gl_stats_set_stage(stage)
+#define GL_STATS_END_FRAME() gl_stats_end_frame()
+
+#else
+
+#define GL_STATS_COUNT(counter)
+#define GL_STATS_STAGE(stage)
+#define GL_STATS_END_FRAME()
+
+#endif
+
+// GL state cache. Binds matching the state already set on the current
+// context are skipped. Contexts are registered by ogl_state_make_current,
+// threads without a registered context call GL directly.
+
+#define OGL_STATE_TEXTURE_UNITS 8
+#define OGL_STATE_UNKNOWN ((GLuint) ~0u)
+
+typedef struct {
+    GLFWwindow *context;
+
+    GLuint program;
+    GLenum active_texture;
+    GLuint textures[OGL_STATE_TEXTURE_UNITS];
+    GLuint vertex_array;
+    GLuint framebuffer;
+    GLenum blend_sfactor;
+    GLenum blend_dfactor;
+    GLenum blend_equation;
+    GLint viewport[4];
+} ogl_state;
+
+extern _Thread_local ogl_state *ogl_current_state;
+
+void ogl_state_make_current(GLFWwindow *context);
+void ogl_state_forget(GLFWwindow *context);
+
+// For code that changed bindings behind the cache back
+void ogl_state_invalidate();
+
+// Deleted names may be reused by GL, so these also drop them from every context cache
+void ogl_delete_program(GLuint program);
+void ogl_delete_textures(GLsizei n, const GLuint *textures);
+void ogl_delete_vertex_arrays(GLsizei n, const GLuint *vertex_arrays);
+void ogl_delete_framebuffers(GLsizei n, const GLuint *framebuffers);
+
+static inline void ogl_use_program(GLuint program) {
+    ogl_state *state = ogl_current_state;
+
+    if (state) {
+        if (state->program == program) {
+            GL_STATS_COUNT(GL_STATS_CACHE_HITS);
+            return;
+        }
+
+        state->program = program;
+    }
+
+    GL_STATS_COUNT(GL_STATS_PROGRAM_BINDS);
+    glUseProgram(program);
+}
+
+static inline void ogl_active_texture(GLenum unit) {
+    ogl_state *state = ogl_current_state;
+
+    if (state) {
+        if (state->active_texture == unit) {
+            GL_STATS_COUNT(GL_STATS_CACHE_HITS);
+            return;
+        }
+
+        state->active_texture = unit;
+    }
+
+    GL_STATS_COUNT(GL_STATS_CALLS);
+    glActiveTexture(unit);
+}
+
+static inline void ogl_bind_texture(GLenum target, GLuint texture) {
+    ogl_state *state = ogl_current_state;
+
+    if (state && target == GL_TEXTURE_2D) {
+        GLuint unit = state->active_texture - GL_TEXTURE0;
+
+        if (unit < OGL_STATE_TEXTURE_UNITS) {
+            if (state->textures[unit] == texture) {
+                GL_STATS_COUNT(GL_STATS_CACHE_HITS);
+                return;
+            }
+
+            state->textures[unit] = texture;
+        }
+    }
+
+    GL_STATS_COUNT(GL_STATS_TEXTURE_BINDS);
+    glBindTexture(target, texture);
+}
+
+static inline void ogl_bind_vertex_array(GLuint vertex_array) {
+    ogl_state *state = ogl_current_state;
+
+    if (state) {
+        if (state->vertex_array == vertex_array) {
+            GL_STATS_COUNT(GL_STATS_CACHE_HITS);
+            return;
+        }
+
+        state->vertex_array = vertex_array;
+    }
+
+    GL_STATS_COUNT(GL_STATS_VERTEX_ARRAY_BINDS);
+    glBindVertexArray(vertex_array);
+}
+
+static inline void ogl_bind_framebuffer(GLenum target, GLuint framebuffer) {
+    ogl_state *state = ogl_current_state;
+
+    if (state && target == GL_FRAMEBUFFER) {
+        if (state->framebuffer == framebuffer) {
+            GL_STATS_COUNT(GL_STATS_CACHE_HITS);
+            return;
+        }
+
+        state->framebuffer = framebuffer;
+    } else if (state) {
+        // Read or draw only binds split the cached pair
+        state->framebuffer = OGL_STATE_UNKNOWN;
+    }
+
+    GL_STATS_COUNT(GL_STATS_FRAMEBUFFER_BINDS);
+    glBindFramebuffer(target, framebuffer);
+}
+
+static inline void ogl_blend_func(GLenum sfactor, GLenum dfactor) {
+    ogl_state *state = ogl_current_state;
+
+    if (state) {
+        if (state->blend_sfactor == sfactor && state->blend_dfactor == dfactor) {
+            GL_STATS_COUNT(GL_STATS_CACHE_HITS);
+            return;
+        }
+
+        state->blend_sfactor = sfactor;
+        state->blend_dfactor = dfactor;
+    }
+
+    GL_STATS_COUNT(GL_STATS_BLEND_CHANGES);
+    glBlendFunc(sfactor, dfactor);
+}
+
+static inline void ogl_blend_equation(GLenum mode) {
+    ogl_state *state = ogl_current_state;
+
+    if (state) {
+        if (state->blend_equation == mode) {
+            GL_STATS_COUNT(GL_STATS_CACHE_HITS);
+            return;
+        }
+
+        state->blend_equation = mode;
+    }
+
+    GL_STATS_COUNT(GL_STATS_BLEND_CHANGES);
+    glBlendEquation(mode);
+}
+
+static inline void ogl_viewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+    ogl_state *state = ogl_current_state;
+
+    if (state) {
+        GLint *viewport = state->viewport;
+
+        if (viewport[0] == x && viewport[1] == y && viewport[2] == width && viewport[3] == height) {
+            GL_STATS_COUNT(GL_STATS_CACHE_HITS);
+            return;
+        }
+
+        viewport[0] = x;
+        viewport[1] = y;
+        viewport[2] = width;
+        viewport[3] = height;
+    }
+
+    GL_STATS_COUNT(GL_STATS_CALLS);
+    glViewport(x, y, width, height);
+}
+
+static inline void ogl_scissor(GLint x, GLint y, GLsizei width, GLsizei height) {
+    GL_STATS_COUNT(GL_STATS_CALLS);
+    glScissor(x, y, width, height);
+}
+
+static inline void ogl_enable_vertex_attrib_array(GLuint index) {
+    GL_STATS_COUNT(GL_STATS_CALLS);
+    glEnableVertexAttribArray(index);
+}
+
+static inline void ogl_disable_vertex_attrib_array(GLuint index) {
+    GL_STATS_COUNT(GL_STATS_CALLS);
+    glDisableVertexAttribArray(index);
+}
+
+static inline void ogl_draw_arrays(GLenum mode, GLint first, GLsizei count) {
+    GL_STATS_COUNT(GL_STATS_DRAWS);
+    glDrawArrays(mode, first, count);
+}
+
+static inline void ogl_draw_elements(GLenum mode, GLsizei count, GLenum type, const void *indices) {
+    GL_STATS_COUNT(GL_STATS_DRAWS);
+    glDrawElements(mode, count, type, indices);
+}
+
+// Immediate mode primitives count as one draw
+static inline void ogl_begin(GLenum mode) {
+    GL_STATS_COUNT(GL_STATS_DRAWS);
+    glBegin(mode);
+}
+
+static inline void ogl_uniform_1i(GLint location, GLint v0) {
+    GL_STATS_COUNT(GL_STATS_UNIFORMS);
+    glUniform1i(location, v0);
+}
+
+static inline void ogl_uniform_1f(GLint location, GLfloat v0) {
+    GL_STATS_COUNT(GL_STATS_UNIFORMS);
+    glUniform1f(location, v0);
+}
+
+static inline void ogl_uniform_2f(GLint location, GLfloat v0, GLfloat v1) {
+    GL_STATS_COUNT(GL_STATS_UNIFORMS);
+    glUniform2f(location, v0, v1);
+}
+
+static inline void ogl_uniform_3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2) {
+    GL_STATS_COUNT(GL_STATS_UNIFORMS);
+    glUniform3f(location, v0, v1, v2);
+}
+
+static inline void ogl_uniform_4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3) {
+    GL_STATS_COUNT(GL_STATS_UNIFORMS);
+    glUniform4f(location, v0, v1, v2, v3);
+}
+
+static inline void ogl_uniform_1fv(GLint location, GLsizei count, const GLfloat *value) {
+    GL_STATS_COUNT(GL_STATS_UNIFORMS);
+    glUniform1fv(location, count, value);
+}
+
 #endif
@@ -0,0 +1,84 @@
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "tinycthread.h"
+#include "parallel.h"
+
+typedef struct {
+    parallel_task task;
+    void *data;
+    int begin;
+    int end;
+} parallel_range;
+
+static int parallel_range_run(void *arg) {
+    parallel_range *range = (parallel_range*) arg;
+    range->task(range->data, range->begin, range->end);
+    return 0;
+}
+
+int parallel_count_threads() {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    int count = (int) info.dwNumberOfProcessors;
+#else
+    int count = (int) sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+
+    if (count < 1) {
+        return 1;
+    }
+
+    return count < PARALLEL_MAX_THREADS ? count : PARALLEL_MAX_THREADS;
+}
+
+void parallel_for(int count, int min_range, parallel_task task, void *data) {
+    if (count <= 0) {
+        return;
+    }
+
+    if (min_range < 1) {
+        min_range = 1;
+    }
+
+    int count_ranges = parallel_count_threads();
+
+    if (count_ranges > count / min_range) {
+        count_ranges = count / min_range;
+    }
+
+    if (count_ranges <= 1) {
+        task(data, 0, count);
+        return;
+    }
+
+    parallel_range ranges[PARALLEL_MAX_THREADS];
+    thrd_t threads[PARALLEL_MAX_THREADS];
+    int started[PARALLEL_MAX_THREADS];
+
+    for (int i = 0; i < count_ranges; i++) {
+        ranges[i].task = task;
+        ranges[i].data = data;
+        ranges[i].begin = (int) (((long long) count * i) / count_ranges);
+        ranges[i].end = (int) (((long long) count * (i + 1)) / count_ranges);
+    }
+
+    // If a thread can not start, its range runs here instead
+    for (int i = 1; i < count_ranges; i++) {
+        started[i] = thrd_create(&threads[i], parallel_range_run, &ranges[i]) == thrd_success;
+    }
+
+    parallel_range_run(&ranges[0]);
+
+    for (int i = 1; i < count_ranges; i++) {
+        if (started[i]) {
+            thrd_join(threads[i], NULL);
+        } else {
+            parallel_range_run(&ranges[i]);
+        }
+    }
+}
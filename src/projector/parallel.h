@@ -0,0 +1,19 @@
+#ifndef _PARALLEL_H_
+#define _PARALLEL_H_
+
+// Fork join helper for CPU heavy config work (mesh tessellation, ...).
+// Threads are started per call, callers are expected to do enough work
+// to pay for them.
+#define PARALLEL_MAX_THREADS 16
+
+// Runs items [begin, end) of the work
+typedef void (*parallel_task)(void *data, int begin, int end);
+
+// Online processors, capped to PARALLEL_MAX_THREADS
+int parallel_count_threads();
+
+// Splits [0, count) in ranges of at least min_range items, one per thread.
+// The calling thread runs the first range. Returns when all ranges are done.
+void parallel_for(int count, int min_range, parallel_task task, void *data);
+
+#endif
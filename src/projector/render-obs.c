@@ -69,19 +69,19 @@ void render_obs_update_assets() {
         dst_height = buffer->height;
 
         glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer->gl_buffer);
-        glBindTexture(GL_TEXTURE_2D, texture_id);
+        ogl_bind_texture(GL_TEXTURE_2D, texture_id);
 
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, dst_width, dst_height, 0, GL_BGRA, GL_UNSIGNED_BYTE, 0);
         tex_set_default_params();
 
-        glBindTexture(GL_TEXTURE_2D, 0);
+        ogl_bind_texture(GL_TEXTURE_2D, 0);
         glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
     }
 
     render_pixel_unpack_buffer_enqueue_for_flush(buffer_instance, buffer);
 }
 void render_obs_deallocate_assets() {
-    glDeleteTextures(1, &texture_id);
+    ogl_delete_textures(1, &texture_id);
 }
 
 void render_obs_render(render_layer *layer) {
@@ -111,18 +111,21 @@ void render_obs_render(render_layer *layer) {
     x = (layer->size.render_width - w) / 2;
     y = (layer->size.render_height - h) / 2;
 
+    ogl_use_program(0);
+
     glColor4f(1.0, 1.0, 1.0, 1.0);
 
-    glBindTexture(GL_TEXTURE_2D, texture_id);
+    ogl_active_texture(GL_TEXTURE0);
+    ogl_bind_texture(GL_TEXTURE_2D, texture_id);
 
-    glBegin(GL_QUADS);
+    ogl_begin(GL_QUADS);
     glTexCoord2f(0.0, 0.0); glVertex2d(x, y);
     glTexCoord2f(0.0, 1.0); glVertex2d(x, y + h);
     glTexCoord2f(1.0, 1.0); glVertex2d(x + w, y + h);
     glTexCoord2f(1.0, 0.0); glVertex2d(x + w, y);
     glEnd();
 
-    glBindTexture(GL_TEXTURE_2D, 0);
+    ogl_bind_texture(GL_TEXTURE_2D, 0);
 }
 
 void render_obs_shutdown() {
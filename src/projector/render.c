@@ -45,22 +45,22 @@ void renders_init() {
     render->rendered_texture = renderedTexture;
 
     // "Bind" the newly created texture : all future texture functions will modify this texture
-    glBindTexture(GL_TEXTURE_2D, renderedTexture);
+    ogl_bind_texture(GL_TEXTURE_2D, renderedTexture);
 
     // Give an empty image to OpenGL ( the last "0" )
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 800, 600, 0, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8_REV, 0);
 
     tex_set_default_params();
 
-    glBindTexture(GL_TEXTURE_2D, 0);
+    ogl_bind_texture(GL_TEXTURE_2D, 0);
 
     GLuint FramebufferName = 0;
     glGenFramebuffers(1, &FramebufferName);
-    glBindFramebuffer(GL_FRAMEBUFFER, FramebufferName);
+    ogl_bind_framebuffer(GL_FRAMEBUFFER, FramebufferName);
 
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, renderedTexture, 0);
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    ogl_bind_framebuffer(GL_FRAMEBUFFER, 0);
 
     render->framebuffer_name = FramebufferName;
     output->rendered_texture = renderedTexture;
@@ -89,15 +89,15 @@ void renders_cycle() {
         return;
     }
 
-    glBindTexture(GL_TEXTURE_2D, render->rendered_texture);
+    ogl_bind_texture(GL_TEXTURE_2D, render->rendered_texture);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8_REV, 0);
     tex_set_default_params();
-    glBindTexture(GL_TEXTURE_2D, 0);
+    ogl_bind_texture(GL_TEXTURE_2D, 0);
 
-    glBindFramebuffer(GL_FRAMEBUFFER, render->framebuffer_name);
+    ogl_bind_framebuffer(GL_FRAMEBUFFER, render->framebuffer_name);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, render->rendered_texture, 0);
 
-    glViewport(0, 0, width, height);
+    ogl_viewport(0, 0, width, height);
 
     glPushMatrix();
     glLoadIdentity();
@@ -106,7 +106,7 @@ void renders_cycle() {
     glClearColor(0.0, 0.0, 0.0, 1.0);
     glClear(GL_COLOR_BUFFER_BIT);
 
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    ogl_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     glEnable(GL_TEXTURE_2D);
     render_obs_render(render);
@@ -114,7 +114,7 @@ void renders_cycle() {
     
     glPopMatrix();
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    ogl_bind_framebuffer(GL_FRAMEBUFFER, 0);
 }
 
 void renders_flush_buffers() {
@@ -130,8 +130,8 @@ void renders_terminate() {
 
     output->rendered_texture = 0;
 
-    glDeleteFramebuffers(1, &render->framebuffer_name);
-    glDeleteTextures(1, &render->rendered_texture);
+    ogl_delete_framebuffers(1, &render->framebuffer_name);
+    ogl_delete_textures(1, &render->rendered_texture);
 }
 
 void renders_push_frame(void *data, int width, int line_size, int height) {
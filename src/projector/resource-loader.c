@@ -0,0 +1,169 @@
+#include <stdatomic.h>
+
+#include "tinycthread.h"
+#include "clock.h"
+#include "debug.h"
+#include "trace.h"
+#include "resource-loader.h"
+
+enum {
+    RESOURCE_LOADER_IDLE,
+    RESOURCE_LOADER_QUEUED,
+    RESOURCE_LOADER_RUNNING,
+    RESOURCE_LOADER_DONE
+};
+
+static GLFWwindow *loader_context;
+
+static thrd_t loader_thread_id;
+static mtx_t loader_mutex;
+static cnd_t loader_cond;
+static int loader_running = 0;
+
+static atomic_int loader_state = RESOURCE_LOADER_IDLE;
+static resource_loader_job current_job;
+static void *current_job_data;
+
+static GLsync current_fence = 0;
+
+static int resource_loader_fence_supported() {
+#ifdef _GLEW_ENABLED_
+    return GLEW_VERSION_3_2 || GLEW_ARB_sync;
+#else
+    return 0;
+#endif
+}
+
+static void resource_loader_fence() {
+    if (resource_loader_fence_supported()) {
+        current_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glFlush();
+    } else {
+        // Blocks only this thread
+        glFinish();
+    }
+}
+
+static int resource_loader_loop(void *_) {
+    trace_set_thread_name("Projector Resource Loader");
+
+    glfwMakeContextCurrent(loader_context);
+
+#ifdef _GLEW_ENABLED_
+    glewInit();
+#endif
+
+    mtx_lock(&loader_mutex);
+
+    while (loader_running) {
+        if (atomic_load(&loader_state) != RESOURCE_LOADER_QUEUED) {
+            cnd_wait(&loader_cond, &loader_mutex);
+            continue;
+        }
+
+        atomic_store(&loader_state, RESOURCE_LOADER_RUNNING);
+        mtx_unlock(&loader_mutex);
+
+        unsigned long long begin_ns = get_time_ns();
+
+        current_job(current_job_data);
+        resource_loader_fence();
+
+        unsigned long long end_ns = get_time_ns();
+
+        trace_complete_event("Resource Loader Job", begin_ns, end_ns);
+        log_debug("Resource loader job built in %.3fms\n", (end_ns - begin_ns) / 1.0e6);
+
+        mtx_lock(&loader_mutex);
+        atomic_store(&loader_state, RESOURCE_LOADER_DONE);
+    }
+
+    mtx_unlock(&loader_mutex);
+
+    glfwMakeContextCurrent(NULL);
+
+    return 0;
+}
+
+void resource_loader_start(GLFWwindow *context) {
+    if (loader_running || context == NULL) {
+        return;
+    }
+
+    loader_context = context;
+
+    mtx_init(&loader_mutex, 0);
+    cnd_init(&loader_cond);
+
+    atomic_store(&loader_state, RESOURCE_LOADER_IDLE);
+    loader_running = 1;
+
+    thrd_create(&loader_thread_id, resource_loader_loop, NULL);
+}
+
+void resource_loader_stop() {
+    if (!loader_running) {
+        return;
+    }
+
+    mtx_lock(&loader_mutex);
+    loader_running = 0;
+    cnd_signal(&loader_cond);
+    mtx_unlock(&loader_mutex);
+
+    thrd_join(loader_thread_id, NULL);
+
+    cnd_destroy(&loader_cond);
+    mtx_destroy(&loader_mutex);
+
+    // Needs a context of the share group to be current
+    if (current_fence) {
+        glDeleteSync(current_fence);
+        current_fence = 0;
+    }
+
+    atomic_store(&loader_state, RESOURCE_LOADER_IDLE);
+}
+
+int resource_loader_running() {
+    return loader_running;
+}
+
+int resource_loader_submit(resource_loader_job job, void *data) {
+    if (!loader_running || atomic_load(&loader_state) != RESOURCE_LOADER_IDLE) {
+        return 0;
+    }
+
+    mtx_lock(&loader_mutex);
+
+    current_job = job;
+    current_job_data = data;
+
+    atomic_store(&loader_state, RESOURCE_LOADER_QUEUED);
+    cnd_signal(&loader_cond);
+
+    mtx_unlock(&loader_mutex);
+
+    return 1;
+}
+
+int resource_loader_poll() {
+    if (atomic_load(&loader_state) != RESOURCE_LOADER_DONE) {
+        return 0;
+    }
+
+    if (current_fence) {
+        GLenum result = glClientWaitSync(current_fence, 0, 0);
+
+        if (result == GL_TIMEOUT_EXPIRED) {
+            return 0;
+        }
+
+        glDeleteSync(current_fence);
+        current_fence = 0;
+    }
+
+    atomic_store(&loader_state, RESOURCE_LOADER_IDLE);
+
+    return 1;
+}
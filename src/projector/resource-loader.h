@@ -0,0 +1,23 @@
+#include "ogl-loader.h"
+
+#ifndef _RESOURCE_LOADER_H_
+#define _RESOURCE_LOADER_H_
+
+// Runs GL jobs on a background thread with its own context, shared with the
+// render contexts. One job is in flight at a time. The render thread polls
+// for completion at frame boundaries and never waits on the GPU.
+
+typedef void (*resource_loader_job)(void *data);
+
+void resource_loader_start(GLFWwindow *context);
+void resource_loader_stop();
+
+int resource_loader_running();
+
+// Returns 0 if the loader is not running or still busy with a previous job
+int resource_loader_submit(resource_loader_job job, void *data);
+
+// Returns 1 once, when the submitted job finished and its GL commands completed
+int resource_loader_poll();
+
+#endif
@@ -0,0 +1,267 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include "tinycthread.h"
+#include "clock.h"
+#include "debug.h"
+#include "trace.h"
+
+#define TRACE_BUFFER_EVENTS 16384
+#define TRACE_NAME_LENGTH 48
+#define TRACE_FLUSH_INTERVAL_MS 100
+// Worst case every character escaped as \u00XX
+#define TRACE_ESCAPED_LENGTH (TRACE_NAME_LENGTH * 6)
+
+typedef struct {
+    char name[TRACE_NAME_LENGTH];
+    char phase;
+    unsigned long long ts_ns;
+    unsigned long long dur_ns;
+} trace_event;
+
+// Single producer (owner thread), single consumer (flush thread) ring.
+typedef struct trace_buffer {
+    trace_event events[TRACE_BUFFER_EVENTS];
+    atomic_uint head;
+    atomic_uint tail;
+    atomic_uint dropped;
+
+    int tid;
+    const char *thread_name;
+    int thread_name_written;
+
+    struct trace_buffer *next;
+} trace_buffer;
+
+static atomic_int enabled = 0;
+static once_flag trace_once = ONCE_FLAG_INIT;
+static mtx_t buffers_mutex;
+static trace_buffer *buffers = NULL;
+static int next_tid = 1;
+
+static _Thread_local trace_buffer *thread_buffer = NULL;
+
+static FILE *trace_file = NULL;
+static unsigned long long trace_begin_ns;
+static thrd_t flush_thread_id;
+static atomic_int flush_thread_running = 0;
+
+static void initialize_trace() {
+    mtx_init(&buffers_mutex, 0);
+}
+
+int trace_enabled() {
+    return atomic_load_explicit(&enabled, memory_order_relaxed);
+}
+
+static trace_buffer* trace_get_thread_buffer() {
+    if (thread_buffer) {
+        return thread_buffer;
+    }
+
+    trace_buffer *buffer = (trace_buffer*) calloc(1, sizeof(trace_buffer));
+
+    // Buffers are never freed: a thread may still be writing after trace_stop.
+    // They are reused by the next trace session instead.
+    mtx_lock(&buffers_mutex);
+    buffer->tid = next_tid++;
+    buffer->next = buffers;
+    buffers = buffer;
+    mtx_unlock(&buffers_mutex);
+
+    thread_buffer = buffer;
+
+    return buffer;
+}
+
+static void trace_push(const char *name, char phase, unsigned long long ts_ns, unsigned long long dur_ns) {
+    trace_buffer *buffer = trace_get_thread_buffer();
+
+    unsigned int head = atomic_load_explicit(&buffer->head, memory_order_relaxed);
+    unsigned int tail = atomic_load_explicit(&buffer->tail, memory_order_acquire);
+
+    if (head - tail >= TRACE_BUFFER_EVENTS) {
+        atomic_fetch_add_explicit(&buffer->dropped, 1, memory_order_relaxed);
+        return;
+    }
+
+    trace_event *event = &buffer->events[head % TRACE_BUFFER_EVENTS];
+
+    strncpy(event->name, name, TRACE_NAME_LENGTH - 1);
+    event->name[TRACE_NAME_LENGTH - 1] = 0;
+    event->phase = phase;
+    event->ts_ns = ts_ns;
+    event->dur_ns = dur_ns;
+
+    atomic_store_explicit(&buffer->head, head + 1, memory_order_release);
+}
+
+void trace_set_thread_name(const char *name) {
+    if (!trace_enabled()) {
+        return;
+    }
+
+    trace_get_thread_buffer()->thread_name = name;
+}
+
+void trace_complete_event(const char *name, unsigned long long begin_ns, unsigned long long end_ns) {
+    if (!trace_enabled()) {
+        return;
+    }
+
+    trace_push(name, 'X', begin_ns, end_ns - begin_ns);
+}
+
+void trace_instant_event(const char *name) {
+    if (!trace_enabled()) {
+        return;
+    }
+
+    trace_push(name, 'i', get_time_ns(), 0);
+}
+
+static double trace_us(unsigned long long ns) {
+    return ns < trace_begin_ns ? 0.0 : (ns - trace_begin_ns) / 1000.0;
+}
+
+// JSON string contents, truncated to fit out
+static const char* trace_escape(const char *in, char *out, size_t size) {
+    size_t length = 0;
+
+    for (; *in && length + 7 <= size; in++) {
+        unsigned char c = (unsigned char) *in;
+
+        if (c == '"' || c == '\\') {
+            out[length++] = '\\';
+            out[length++] = (char) c;
+        } else if (c < 0x20) {
+            length += snprintf(out + length, size - length, "\\u%04x", c);
+        } else {
+            out[length++] = (char) c;
+        }
+    }
+
+    out[length] = 0;
+
+    return out;
+}
+
+static void trace_flush_buffers() {
+    char escaped[TRACE_ESCAPED_LENGTH];
+
+    mtx_lock(&buffers_mutex);
+
+    for (trace_buffer *buffer = buffers; buffer; buffer = buffer->next) {
+        if (buffer->thread_name && !buffer->thread_name_written) {
+            fprintf(trace_file,
+                "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%i,\"args\":{\"name\":\"%s\"}},\n",
+                buffer->tid, trace_escape(buffer->thread_name, escaped, sizeof(escaped)));
+
+            buffer->thread_name_written = 1;
+        }
+
+        unsigned int tail = atomic_load_explicit(&buffer->tail, memory_order_relaxed);
+        unsigned int head = atomic_load_explicit(&buffer->head, memory_order_acquire);
+
+        for (; tail != head; tail++) {
+            trace_event *event = &buffer->events[tail % TRACE_BUFFER_EVENTS];
+
+            if (event->phase == 'X') {
+                fprintf(trace_file,
+                    "{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%i},\n",
+                    trace_escape(event->name, escaped, sizeof(escaped)), trace_us(event->ts_ns), event->dur_ns / 1000.0, buffer->tid);
+            } else {
+                fprintf(trace_file,
+                    "{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":1,\"tid\":%i},\n",
+                    trace_escape(event->name, escaped, sizeof(escaped)), trace_us(event->ts_ns), buffer->tid);
+            }
+        }
+
+        atomic_store_explicit(&buffer->tail, tail, memory_order_release);
+
+        unsigned int dropped = atomic_exchange_explicit(&buffer->dropped, 0, memory_order_relaxed);
+
+        if (dropped) {
+            log_debug("Trace buffer of thread %i full. Dropped %u events\n", buffer->tid, dropped);
+        }
+    }
+
+    mtx_unlock(&buffers_mutex);
+
+    fflush(trace_file);
+}
+
+int trace_flush_loop(void *_) {
+    struct timespec sleep_interval;
+
+    while (atomic_load(&flush_thread_running)) {
+        sleep_interval.tv_sec = 0;
+        sleep_interval.tv_nsec = TRACE_FLUSH_INTERVAL_MS * 1000000L;
+
+        thrd_sleep(&sleep_interval, 0);
+
+        trace_flush_buffers();
+    }
+
+    return 0;
+}
+
+void trace_start(const char *file_path) {
+    if (file_path == NULL || file_path[0] == 0 || trace_enabled()) {
+        return;
+    }
+
+    call_once(&trace_once, initialize_trace);
+
+    trace_file = fopen(file_path, "w");
+
+    if (trace_file == NULL) {
+        log_debug("Failed to open trace file: %s\n", file_path);
+        return;
+    }
+
+    fprintf(trace_file, "[\n");
+    fprintf(trace_file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"OBS Projector\"}},\n");
+
+    mtx_lock(&buffers_mutex);
+
+    for (trace_buffer *buffer = buffers; buffer; buffer = buffer->next) {
+        atomic_store(&buffer->tail, atomic_load(&buffer->head));
+        buffer->thread_name_written = 0;
+    }
+
+    mtx_unlock(&buffers_mutex);
+
+    trace_begin_ns = get_time_ns();
+
+    atomic_store(&flush_thread_running, 1);
+    thrd_create(&flush_thread_id, trace_flush_loop, NULL);
+
+    atomic_store(&enabled, 1);
+
+    log_debug("Tracing render loop to %s\n", file_path);
+}
+
+void trace_stop() {
+    if (!trace_enabled()) {
+        return;
+    }
+
+    atomic_store(&enabled, 0);
+
+    atomic_store(&flush_thread_running, 0);
+    thrd_join(flush_thread_id, NULL);
+
+    trace_flush_buffers();
+
+    fprintf(trace_file,
+        "{\"name\":\"trace_end\",\"ph\":\"i\",\"s\":\"g\",\"ts\":%.3f,\"pid\":1,\"tid\":0}\n]\n",
+        trace_us(get_time_ns()));
+
+    fclose(trace_file);
+    trace_file = NULL;
+
+    log_debug("Trace finished\n");
+}
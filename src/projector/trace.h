@@ -0,0 +1,19 @@
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+// Chrome / Perfetto trace-event export.
+// Disabled unless trace_start receives a file path. Open the resulting
+// file in chrome://tracing or https://ui.perfetto.dev
+
+#define TRACE_ENV_VAR "PROJECTOR_TRACE_FILE"
+
+void trace_start(const char *file_path);
+void trace_stop();
+
+int trace_enabled();
+
+void trace_set_thread_name(const char *name);
+void trace_complete_event(const char *name, unsigned long long begin_ns, unsigned long long end_ns);
+void trace_instant_event(const char *name);
+
+#endif
@@ -1,16 +1,15 @@
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-#define REAL double
-#define VOID void
-#define __UINT64 __uint64
-
-#include "triangle.h"
-
 #include "custom-math.h"
+#include "clock.h"
 #include "ogl-loader.h"
 #include "debug.h"
 #include "config-structs.h"
+#include "config.h"
+#include "config-mesh.h"
+#include "config-remap.h"
 #include "virtual-screen.h"
 #include "vs-black-level-adjust.h"
 #include "vs-blend.h"
@@ -22,6 +21,12 @@ static GLuint fragmentshader;
 static GLuint program;
 static GLuint textureUniform;
 static GLuint adjustFactorUniform;
+static GLuint positionBoundsUniform;
+
+static GLuint remapVertexShader;
+static GLuint remapFragmentShader;
+static GLuint remapProgram;
+static GLuint remapAdjustFactorUniform;
 
 void virtual_screen_shared_initialize() {
     vs_color_corrector_init();
@@ -44,157 +49,284 @@ void virtual_screen_monitor_initialize() {
 
     textureUniform = glGetUniformLocation(program, "image");
     adjustFactorUniform = glGetUniformLocation(program, "adjust_factor");
+    positionBoundsUniform = glGetUniformLocation(program, "position_bounds");
+
+    ogl_use_program(program);
+    ogl_uniform_1i(textureUniform, 0);
+    ogl_use_program(0);
+
+    remapVertexShader = loadShader(GL_VERTEX_SHADER, "remap.vertex.shader");
+    remapFragmentShader = loadShader(GL_FRAGMENT_SHADER, "remap.fragment.shader");
+
+    remapProgram = glCreateProgram();
+    glAttachShader(remapProgram, remapVertexShader);
+    glAttachShader(remapProgram, remapFragmentShader);
+
+    glBindAttribLocation(remapProgram, 0, "in_Position");
+    glBindAttribLocation(remapProgram, 1, "in_Uv");
+
+    glLinkProgram(remapProgram);
+    glValidateProgram(remapProgram);
 
-    glUseProgram(0);
+    remapAdjustFactorUniform = glGetUniformLocation(remapProgram, "adjust_factor");
+
+    ogl_use_program(remapProgram);
+    ogl_uniform_1i(glGetUniformLocation(remapProgram, "image"), 0);
+    ogl_uniform_1i(glGetUniformLocation(remapProgram, "remap"), 1);
+    ogl_use_program(0);
 }
 
-void virtual_screen_free_triangulateio(struct triangulateio *in) {
-    if (in->pointlist) {
-        free(in->pointlist);
-    }
-    if (in->pointattributelist) {
-        free(in->pointattributelist);
-    }
-    if (in->pointmarkerlist) {
-        free(in->pointmarkerlist);
-    }
-    if (in->trianglelist) {
-        free(in->trianglelist);
-    }
-    if (in->triangleattributelist) {
-        free(in->triangleattributelist);
-    }
-    if (in->trianglearealist) {
-        free(in->trianglearealist);
-    }
-    if (in->neighborlist) {
-        free(in->neighborlist);
-    }
-    if (in->segmentlist) {
-        free(in->segmentlist);
-    }
-    if (in->segmentmarkerlist) {
-        free(in->segmentmarkerlist);
-    }
-    if (in->edgelist) {
-        free(in->edgelist);
+void virtual_screen_monitor_load_vertexes(config_display *display, config_virtual_screen *config, virtual_screen *data) {
+    config_mesh built_mesh;
+    config_mesh *mesh = &config->mesh;
+
+    // Configs not loaded from a file (e.g. the default one) are not triangulated yet
+    if (mesh->vertexes == NULL) {
+        config_mesh_build(display, config, &built_mesh, NULL);
+        mesh = &built_mesh;
     }
-    if (in->edgemarkerlist) {
-        free(in->edgemarkerlist);
+
+    data->indexes_count = mesh->count_indexes;
+    memcpy(data->position_bounds, mesh->position_bounds, sizeof(data->position_bounds));
+    memcpy(data->visible_bounds, mesh->visible_bounds, sizeof(data->visible_bounds));
+
+    size_t vertexes_size = mesh->count_vertexes * 4 * sizeof(GLushort);
+    size_t indexes_size = mesh->count_indexes * sizeof(GLuint);
+
+    GLuint vertexbuffer;
+    glGenBuffers(1, &vertexbuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexbuffer);
+    glBufferData(GL_ARRAY_BUFFER, vertexes_size, mesh->vertexes, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    data->vertexbuffer = vertexbuffer;
+
+    // Element buffer bindings are stored in the bound vertex array
+    ogl_bind_vertex_array(0);
+
+    GLuint indexbuffer;
+    glGenBuffers(1, &indexbuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexbuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexes_size, mesh->indexes, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    data->indexbuffer = indexbuffer;
+
+    // Compared to one float position and uv per triangle corner
+    log_debug("Virtual screen mesh uploaded: %i vertexes, %i indexes, %zu bytes (%zu bytes unindexed)\n",
+        mesh->count_vertexes,
+        mesh->count_indexes,
+        vertexes_size + indexes_size,
+        mesh->count_indexes * 4 * sizeof(GLfloat));
+
+    if (mesh == &built_mesh) {
+        config_mesh_free(&built_mesh);
     }
 }
 
-void virtual_screen_monitor_load_vertexes(config_display *display, config_virtual_screen *config, virtual_screen *data) {
-    struct triangulateio in, out;
-    int pindex;
-    GLfloat x, y;
+void virtual_screen_monitor_load_remap(config_display *display, config_virtual_screen *config, virtual_screen *data) {
+    config_mesh built_mesh;
+    config_mesh *mesh = &config->mesh;
 
-    memset(&in, 0, sizeof(struct triangulateio));
-    memset(&out, 0, sizeof(struct triangulateio));
+    if (mesh->vertexes == NULL) {
+        config_mesh_build(display, config, &built_mesh, NULL);
+        mesh = &built_mesh;
+    }
 
-    GLuint vertexarray;
-    
-    glUseProgram(program);
-    
-    glGenVertexArrays(1, &vertexarray);
-    glBindVertexArray(vertexarray);
+    unsigned long long begin_ns = get_time_ns();
 
-    data->vertexarray = vertexarray;
+    config_remap remap;
+    config_remap_build(display, mesh, &remap);
 
-    int count_points = config->monitor_position.count_points;
+    double bake_ms = (get_time_ns() - begin_ns) / 1.0e6;
+    int count_triangles = mesh->count_indexes / 3;
 
-    in.numberofpoints = count_points;
-    in.numberofpointattributes = 0;
+    memcpy(data->visible_bounds, mesh->visible_bounds, sizeof(data->visible_bounds));
 
-    in.pointlist = (REAL*) calloc(count_points * 2, sizeof(REAL));
-    in.pointmarkerlist = (int *) calloc(count_points, sizeof(int));
+    if (mesh == &built_mesh) {
+        config_mesh_free(&built_mesh);
+    }
 
-    // Output Vertexes
+    data->remap_warp = 1;
 
-    for (int i = 0; i < count_points; i++) {
-        in.pointlist[i * 2] = config->monitor_position.output_points[i].x;
-        in.pointlist[(i * 2) + 1] = config->monitor_position.output_points[i].y;
-        in.pointmarkerlist[i] = i;
+    if (remap.uvs == NULL) {
+        log_debug("Virtual screen remap is empty, mesh is off the display\n");
+        memset(data->visible_bounds, 0, sizeof(data->visible_bounds));
+        return;
     }
 
-    triangulate("pcz", &in, &out, NULL);
+    GLuint remap_texture;
+    glGenTextures(1, &remap_texture);
+    ogl_bind_texture(GL_TEXTURE_2D, remap_texture);
 
-    data->points_count = out.numberoftriangles * 3;
+    // Rows of 2 unsigned shorts per pixel are always 4 byte aligned
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RG16, remap.w, remap.h, 0, GL_RG, GL_UNSIGNED_SHORT, remap.uvs);
 
-    GLfloat *vertexes = (GLfloat*) calloc(out.numberoftriangles * 3 * 4, sizeof(GLfloat));
+    // One texel per display pixel, u, v must not be filtered across the mesh border
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-    for (int i = 0; i < (out.numberoftriangles * 3); i++) {
-        pindex = out.trianglelist[i];
+    ogl_bind_texture(GL_TEXTURE_2D, 0);
 
-        x = (GLfloat) out.pointlist[pindex * 2];
-        y = (GLfloat) out.pointlist[(pindex * 2) + 1];
+    data->remap_texture = remap_texture;
 
-        x = (x * 2.0 / display->monitor_bounds.w) - 1.0;
-        y = 1.0 - (y * 2.0 / display->monitor_bounds.h);
+    // Quad over the remap pixels, in display clip space
+    GLfloat x0 = ((2.0f * remap.x) / display->monitor_bounds.w) - 1.0f;
+    GLfloat y0 = ((2.0f * remap.y) / display->monitor_bounds.h) - 1.0f;
+    GLfloat x1 = ((2.0f * (remap.x + remap.w)) / display->monitor_bounds.w) - 1.0f;
+    GLfloat y1 = ((2.0f * (remap.y + remap.h)) / display->monitor_bounds.h) - 1.0f;
 
-        vertexes[i * 4] = x;
-        vertexes[(i * 4) + 1] = (float) y;
-        vertexes[(i * 4) + 2] = (float) 0.0;
-        vertexes[(i * 4) + 3] = (float) 1.0;
-    }
+    GLfloat positions[] = { x0, y0, x1, y0, x1, y1, x0, y1 };
+    GLfloat uvs[] = { 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f };
 
-    GLuint vertexbuffer;
-    glGenBuffers(1, &vertexbuffer);
-    glBindBuffer(GL_ARRAY_BUFFER, vertexbuffer);
-    glBufferData(GL_ARRAY_BUFFER, out.numberoftriangles * 3 * 4 * sizeof(GLfloat), vertexes, GL_STATIC_DRAW);
+    glGenBuffers(1, &data->vertexbuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, data->vertexbuffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(positions), positions, GL_STATIC_DRAW);
+
+    glGenBuffers(1, &data->remap_uvbuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, data->remap_uvbuffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(uvs), uvs, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    log_debug("Virtual screen remap baked: %ix%i pixels, %i triangles, %zu bytes in %.3fms\n",
+        remap.w,
+        remap.h,
+        count_triangles,
+        (size_t) remap.w * remap.h * 2 * sizeof(GLushort),
+        bake_ms);
 
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, 0);
+    config_remap_free(&remap);
+}
 
+void virtual_screen_monitor_unload_vertexes(virtual_screen *vs) {
+    // Delete the vertex VBO
     glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glDeleteBuffers(1, &vs->vertexbuffer);
 
-    free(vertexes);
+    // Delete the index buffer
+    glDeleteBuffers(1, &vs->indexbuffer);
 
-    data->vertexbuffer = vertexbuffer;
+    // Delete the remap quad uvs and texture, unused when drawing the mesh
+    glDeleteBuffers(1, &vs->remap_uvbuffer);
 
-    // UV Buffer
+    if (vs->remap_texture) {
+        ogl_delete_textures(1, &vs->remap_texture);
+    }
 
-    vertexes = (GLfloat*) calloc(out.numberoftriangles * 3 * 2, sizeof(GLfloat));
+    // Delete the VAO
+    ogl_delete_vertex_arrays(1, &vs->vertexarray);
+
+    // Updates load again into the same struct, possibly in the other warp mode
+    vs->vertexarray = 0;
+    vs->vertexbuffer = 0;
+    vs->indexbuffer = 0;
+    vs->indexes_count = 0;
+    memset(vs->visible_bounds, 0, sizeof(vs->visible_bounds));
+    vs->remap_warp = 0;
+    vs->remap_texture = 0;
+    vs->remap_uvbuffer = 0;
+}
 
-    for (int i = 0; i < out.numberoftriangles * 3; i++) {
-        pindex = out.trianglelist[i];
+void virtual_screen_monitor_build(config_display* display, config_virtual_screen* config, void* data) {
+    if (config->remap_warp) {
+        virtual_screen_monitor_load_remap(display, config, (virtual_screen*) data);
+    } else {
+        virtual_screen_monitor_load_vertexes(display, config, (virtual_screen*) data);
+    }
+}
 
-        x = (GLfloat) config->monitor_position.input_points[pindex].x;
-        y = (GLfloat)config->monitor_position.input_points[pindex].y;
+void virtual_screen_monitor_attach(void* data) {
+    virtual_screen* vs = (virtual_screen*)data;
 
-        x = x / (GLfloat) config->w;
-        y = y / (GLfloat) config->h;
-        
-        vertexes[i * 2] = CLAMP(x, 0.0, 1.0);
-        vertexes[(i * 2) + 1] = CLAMP(y, 0, 1);
+    if (vs->remap_warp) {
+        if (vs->remap_texture) {
+            vs->vertexarray = ogl_create_vertex_array(vs->vertexbuffer, 2, vs->remap_uvbuffer);
+        }
+    } else {
+        vs->vertexarray = ogl_create_packed_vertex_array(vs->vertexbuffer, vs->indexbuffer);
     }
+}
 
-    GLuint uvbuffer;
-    glGenBuffers(1, &uvbuffer);
-    glBindBuffer(GL_ARRAY_BUFFER, uvbuffer);
-    glBufferData(GL_ARRAY_BUFFER, out.numberoftriangles * 3 * 2 * sizeof(GLfloat), vertexes, GL_STATIC_DRAW);
+void virtual_screen_monitor_start(config_display* display, render_output* render, config_virtual_screen* config, void* data) {
+    virtual_screen_monitor_build(display, config, data);
+    virtual_screen_monitor_attach(data);
+}
 
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, 0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+void virtual_screen_monitor_update(config_display *display, render_output *render, config_virtual_screen *config, void *data, int changes) {
+    virtual_screen *vs = (virtual_screen*) data;
 
-    free(vertexes);
+    // UVs are normalized by the virtual screen size
+    if (changes & (CONFIG_VS_CHANGE_MESH | CONFIG_VS_CHANGE_SIZE)) {
+        virtual_screen_monitor_unload_vertexes(vs);
+        virtual_screen_monitor_start(display, render, config, data);
+    }
+}
 
-    virtual_screen_free_triangulateio(&out);
+int virtual_screen_monitor_can_patch(config_virtual_screen *previous, config_virtual_screen *config, int changes) {
+    config_mesh *before = &previous->mesh;
+    config_mesh *after = &config->mesh;
+
+    return
+        (changes & CONFIG_VS_CHANGE_MESH) &&
+        (changes & CONFIG_VS_CHANGE_SIZE) == 0 &&
+        !previous->remap_warp && !config->remap_warp &&
+        before->vertexes && after->vertexes &&
+        before->count_vertexes == after->count_vertexes &&
+        before->count_indexes == after->count_indexes;
+}
 
-    free(in.pointlist);
-    free(in.pointmarkerlist);
+// Uploads the elements differing from previous, runs closer than
+// VIRTUAL_SCREEN_PATCH_GAP elements are merged. Returns the upload count.
+static int virtual_screen_monitor_patch_buffer(GLuint buffer, const void *previous, const void *next, size_t count, size_t element_size) {
+    const char *before = (const char*) previous;
+    const char *after = (const char*) next;
+    int uploads = 0;
+    size_t i = 0;
+
+    // Any target uploads, the element array one is stored in the bound VAO
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+
+    while (i < count) {
+        if (memcmp(before + (i * element_size), after + (i * element_size), element_size) == 0) {
+            i++;
+            continue;
+        }
+
+        size_t first = i, last = i;
+
+        for (i++; i < count && i <= last + VIRTUAL_SCREEN_PATCH_GAP; i++) {
+            if (memcmp(before + (i * element_size), after + (i * element_size), element_size) != 0) {
+                last = i;
+            }
+        }
+
+        glBufferSubData(GL_ARRAY_BUFFER, first * element_size, (last - first + 1) * element_size, after + (first * element_size));
+        uploads++;
+    }
 
-    data->uvbuffer = uvbuffer;
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-    glBindVertexArray(0);
-    glUseProgram(0);
+    return uploads;
 }
 
-void virtual_screen_monitor_start(config_display* display, render_output* render, config_virtual_screen* config, void* data) {
-    virtual_screen* vs = (virtual_screen*)data;
-    virtual_screen_monitor_load_vertexes(display, config, vs);
+void virtual_screen_monitor_patch(config_virtual_screen *previous, config_virtual_screen *config, void *data) {
+    virtual_screen *vs = (virtual_screen*) data;
+    config_mesh *before = &previous->mesh;
+    config_mesh *after = &config->mesh;
+
+    // Moving a hull point moves the bounds, then every vertex changes
+    memcpy(vs->position_bounds, after->position_bounds, sizeof(vs->position_bounds));
+    memcpy(vs->visible_bounds, after->visible_bounds, sizeof(vs->visible_bounds));
+
+    int vertex_uploads = virtual_screen_monitor_patch_buffer(vs->vertexbuffer, before->vertexes, after->vertexes, after->count_vertexes, 4 * sizeof(GLushort));
+    int index_uploads = virtual_screen_monitor_patch_buffer(vs->indexbuffer, before->indexes, after->indexes, after->count_indexes, sizeof(GLuint));
+
+    log_debug("Virtual screen mesh patched: %i vertex and %i index uploads\n", vertex_uploads, index_uploads);
 }
 
-void virtual_screen_shared_start(config_display *display, render_output *render, config_virtual_screen *config, void **data) {
+void virtual_screen_shared_build(config_display *display, render_output *render, config_virtual_screen *config, void **data) {
     virtual_screen *vs = (virtual_screen*) calloc(1, sizeof(virtual_screen));
     (*data) = (void*) vs;
 
@@ -209,36 +341,92 @@ void virtual_screen_shared_start(config_display *display, render_output *render,
     vs->texture_id = renderedTexture;
 
     // "Bind" the newly created texture : all future texture functions will modify this texture
-    glBindTexture(GL_TEXTURE_2D, renderedTexture);
+    ogl_bind_texture(GL_TEXTURE_2D, renderedTexture);
 
     // Give an empty image to OpenGL ( the last "0" )
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0 , GL_RGBA, GL_UNSIGNED_BYTE, 0);
 
     tex_set_default_params();
 
-    glBindTexture(GL_TEXTURE_2D, 0);
+    ogl_bind_texture(GL_TEXTURE_2D, 0);
+
+    vs_color_corrector_build(config, vs->render_output, &vs->color_corrector);
+    vs_blend_build(config, &vs->blend);
+}
+
+void virtual_screen_shared_attach(config_virtual_screen *config, void *data) {
+    virtual_screen *vs = (virtual_screen*) data;
 
     GLuint framebuffer_id = 0;
     glGenFramebuffers(1, &framebuffer_id);
-    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_id);
+    ogl_bind_framebuffer(GL_FRAMEBUFFER, framebuffer_id);
 
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, renderedTexture, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, vs->texture_id, 0);
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    ogl_bind_framebuffer(GL_FRAMEBUFFER, 0);
 
     vs->framebuffer_id = framebuffer_id;
 
-    vs_color_corrector_start(config, vs->render_output, &vs->color_corrector);
-    vs_blend_start(config, &vs->blend);
+    vs_color_corrector_attach(&vs->color_corrector);
+    vs_blend_attach(&vs->blend);
+
+    // The render size may have changed since build
+    vs_color_corrector_update(config, vs->render_output, &vs->color_corrector, 0);
+}
+
+void virtual_screen_shared_start(config_display *display, render_output *render, config_virtual_screen *config, void **data) {
+    virtual_screen_shared_build(display, render, config, data);
+    virtual_screen_shared_attach(config, *data);
+}
+
+void virtual_screen_shared_update(config_display *display, render_output *render, config_virtual_screen *config, void *data, int changes) {
+    virtual_screen *vs = (virtual_screen*) data;
+
+    if (changes & CONFIG_VS_CHANGE_SIZE) {
+        // Reallocating storage keeps the framebuffer attachment
+        ogl_bind_texture(GL_TEXTURE_2D, vs->texture_id);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, config->w, config->h, 0 , GL_RGBA, GL_UNSIGNED_BYTE, 0);
+    }
+
+    vs_color_corrector_update(config, vs->render_output, &vs->color_corrector, changes);
+    vs_blend_update(config, &vs->blend, changes);
+}
+
+void virtual_screen_shared_create_measures(void *data, int display_index, int virtual_screen_index) {
+    virtual_screen *vs = (virtual_screen*) data;
+    char name[64];
+
+    snprintf(name, sizeof(name), "Display %i VS %i Color Corrector", display_index, virtual_screen_index);
+    vs->color_corrector_measure = create_gpu_measure(name);
+
+    snprintf(name, sizeof(name), "Display %i VS %i Blend", display_index, virtual_screen_index);
+    vs->blend_measure = create_gpu_measure(name);
+
+    snprintf(name, sizeof(name), "Display %i VS %i Black Level Adjust", display_index, virtual_screen_index);
+    vs->black_level_adjust_measure = create_gpu_measure(name);
+
+    snprintf(name, sizeof(name), "Display %i VS %i Render", display_index, virtual_screen_index);
+    vs->render_measure = create_measure(name);
+}
+
+static int virtual_screen_visible(virtual_screen *vs) {
+    return vs->visible_bounds[2] > 0.0f && vs->visible_bounds[3] > 0.0f;
 }
 
 void virtual_screen_shared_render(config_virtual_screen *config, void *data) {
     virtual_screen *vs = (virtual_screen*) data;
     config_color_factor *background_clear_color = &config->background_clear_color;
 
-    glBindFramebuffer(GL_FRAMEBUFFER, vs->framebuffer_id);
+    // Nothing of it reaches the display
+    if (!virtual_screen_visible(vs)) {
+        return;
+    }
+
+    begin_measure(vs->render_measure);
 
-    glViewport(0, 0, config->w, config->h);
+    ogl_bind_framebuffer(GL_FRAMEBUFFER, vs->framebuffer_id);
+
+    ogl_viewport(0, 0, config->w, config->h);
 
     glClearColor(background_clear_color->r, background_clear_color->g, background_clear_color->b, background_clear_color->a);
     glClear(GL_COLOR_BUFFER_BIT);
@@ -247,49 +435,91 @@ void virtual_screen_shared_render(config_virtual_screen *config, void *data) {
     glLoadIdentity();
     glOrtho(0.0, config->w, 0.0, config->h, 0.0, 1.0);
 
+    begin_gpu_measure(vs->color_corrector_measure);
     vs_color_corrector_render(config, vs->render_output, &vs->color_corrector);
+    end_gpu_measure(vs->color_corrector_measure);
+
+    begin_gpu_measure(vs->blend_measure);
     vs_blend_render(&vs->blend);
+    end_gpu_measure(vs->blend_measure);
+
     vs_help_lines_render(config);
+
+    begin_gpu_measure(vs->black_level_adjust_measure);
     vs_black_level_adjust_render(config);
+    end_gpu_measure(vs->black_level_adjust_measure);
 
     glPopMatrix();
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    end_measure(vs->render_measure);
 }
 
-void virtual_screen_monitor_print(config_virtual_screen *config, void *data) {
-    virtual_screen *vs = (virtual_screen*) data;
-
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+static void virtual_screen_monitor_print_remap(config_virtual_screen *config, virtual_screen *vs) {
+    if (vs->remap_texture == 0) {
+        return;
+    }
 
-    glColor4d(1.0, 1.0, 1.0, 1.0);
+    ogl_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    glBindTexture(GL_TEXTURE_2D, vs->texture_id);
+    ogl_use_program(remapProgram);
 
-    glUseProgram(program);
+    ogl_active_texture(GL_TEXTURE1);
+    ogl_bind_texture(GL_TEXTURE_2D, vs->remap_texture);
 
-    glActiveTexture(GL_TEXTURE0);
-    glUniform1i(textureUniform, 0);
+    ogl_active_texture(GL_TEXTURE0);
+    ogl_bind_texture(GL_TEXTURE_2D, vs->texture_id);
 
-    glUniform2f(
-        adjustFactorUniform,
+    ogl_uniform_2f(
+        remapAdjustFactorUniform,
         config->monitor_position.output_horizontal_adjust_factor,
         config->monitor_position.output_vertical_adjust_factor);
 
-    glBindVertexArray(vs->vertexarray);
-    glEnableVertexAttribArray(0);
-    glEnableVertexAttribArray(1);
+    ogl_bind_vertex_array(vs->vertexarray);
+    ogl_draw_arrays(GL_TRIANGLE_FAN, 0, 4);
+}
+
+void virtual_screen_monitor_print(config_virtual_screen *config, void *data, int width, int height) {
+    virtual_screen *vs = (virtual_screen*) data;
+
+    if (!virtual_screen_visible(vs)) {
+        return;
+    }
+
+    // Pixels the visible bounds touch, fragments of other virtual screens' areas are cut
+    float *bounds = vs->visible_bounds;
+    int x0 = (int) floorf((bounds[0] + 1.0f) * 0.5f * width);
+    int y0 = (int) floorf((bounds[1] + 1.0f) * 0.5f * height);
+    int x1 = (int) ceilf((bounds[0] + bounds[2] + 1.0f) * 0.5f * width);
+    int y1 = (int) ceilf((bounds[1] + bounds[3] + 1.0f) * 0.5f * height);
+
+    ogl_scissor(x0, y0, x1 - x0, y1 - y0);
+
+    if (vs->remap_warp) {
+        virtual_screen_monitor_print_remap(config, vs);
+        return;
+    }
+
+    ogl_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    glDrawArrays(GL_TRIANGLES, 0, vs->points_count);
+    ogl_use_program(program);
 
-    glDisableVertexAttribArray(0);
-    glDisableVertexAttribArray(1);
-    glBindVertexArray(0);
+    ogl_active_texture(GL_TEXTURE0);
+    ogl_bind_texture(GL_TEXTURE_2D, vs->texture_id);
 
-    glUseProgram(0);
+    ogl_uniform_2f(
+        adjustFactorUniform,
+        config->monitor_position.output_horizontal_adjust_factor,
+        config->monitor_position.output_vertical_adjust_factor);
 
-    glBindTexture(GL_TEXTURE_2D, 0);
+    ogl_uniform_4f(
+        positionBoundsUniform,
+        vs->position_bounds[0],
+        vs->position_bounds[1],
+        vs->position_bounds[2],
+        vs->position_bounds[3]);
 
+    ogl_bind_vertex_array(vs->vertexarray);
+    ogl_draw_elements(GL_TRIANGLES, vs->indexes_count, GL_UNSIGNED_INT, 0);
 }
 
 void virtual_screen_shared_stop(void *data) {
@@ -298,31 +528,19 @@ void virtual_screen_shared_stop(void *data) {
     vs_color_corrector_stop(&vs->color_corrector);
     vs_blend_stop(&vs->blend);
 
-    glDeleteFramebuffers(1, &vs->framebuffer_id);
-    glDeleteTextures(1, &vs->texture_id);
+    destroy_gpu_measure(vs->color_corrector_measure);
+    destroy_gpu_measure(vs->blend_measure);
+    destroy_gpu_measure(vs->black_level_adjust_measure);
+    destroy_measure(vs->render_measure);
+
+    ogl_delete_framebuffers(1, &vs->framebuffer_id);
+    ogl_delete_textures(1, &vs->texture_id);
 }
 
 void virtual_screen_monitor_stop(void* data) {
     virtual_screen* vs = (virtual_screen*)data;
 
-    // Select the VAO
-    glBindVertexArray(vs->vertexarray);
-
-    // Disable the VBO index from the VAO attributes list
-    glDisableVertexAttribArray(0);
-    glDisableVertexAttribArray(1);
-
-    // Delete the vertex VBO
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glDeleteBuffers(1, &vs->vertexbuffer);
-
-    // Delete the color VBO
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glDeleteBuffers(1, &vs->uvbuffer);
-
-    // Delete the VAO
-    glBindVertexArray(0);
-    glDeleteVertexArrays(1, &vs->vertexarray);
+    virtual_screen_monitor_unload_vertexes(vs);
 
     free(data);
 }
@@ -333,11 +551,17 @@ void virtual_screen_shared_shutdown() {
 }
 
 void virtual_screen_monitor_shutdown() {
-    glUseProgram(0);
+    ogl_use_program(0);
 
     glDetachShader(program, vertexshader);
     glDetachShader(program, fragmentshader);
     glDeleteShader(vertexshader);
     glDeleteShader(fragmentshader);
-    glDeleteProgram(program);
+    ogl_delete_program(program);
+
+    glDetachShader(remapProgram, remapVertexShader);
+    glDetachShader(remapProgram, remapFragmentShader);
+    glDeleteShader(remapVertexShader);
+    glDeleteShader(remapFragmentShader);
+    ogl_delete_program(remapProgram);
 }
@@ -4,10 +4,15 @@
 #include "vs-color-corrector.h"
 #include "vs-blend.h"
 #include "render.h"
+#include "gpu-measure.h"
+#include "debug.h"
 
 #ifndef _VIRTUAL_SCREEN_H
 #define _VIRTUAL_SCREEN_H
 
+// Mesh patches merge changed runs closer than this many elements in one upload
+#define VIRTUAL_SCREEN_PATCH_GAP 64
+
 typedef struct {
     render_output *render_output;
 
@@ -16,12 +21,27 @@ typedef struct {
 
     GLuint vertexarray;
     GLuint vertexbuffer;
-    GLuint uvbuffer;
+    GLuint indexbuffer;
+
+    unsigned int indexes_count;
+    float position_bounds[4];
+
+    // Display area the warp can draw to, see config_mesh, nothing is rendered when empty
+    float visible_bounds[4];
 
-    unsigned int points_count;
+    // Remap warp: vertexbuffer holds the remap quad, no texture when off the display
+    int remap_warp;
+    GLuint remap_texture;
+    GLuint remap_uvbuffer;
 
     vs_color_corrector color_corrector;
     vs_blend blend;
+
+    gpu_measure *color_corrector_measure;
+    gpu_measure *blend_measure;
+    gpu_measure *black_level_adjust_measure;
+
+    time_measure *render_measure;
 } virtual_screen;
 
 void virtual_screen_shared_initialize();
@@ -30,8 +50,31 @@ void virtual_screen_monitor_initialize();
 void virtual_screen_shared_start(config_display *display, render_output *render, config_virtual_screen *config, void **data);
 void virtual_screen_monitor_start(config_display* display, render_output* render, config_virtual_screen* config, void* data);
 
+// Start split in two steps. Build creates textures and buffers, including the
+// warp mesh triangulation, and can run on a background context of the share
+// group. Attach creates the per-context objects (FBO, VAOs) and must run on the
+// shared / monitor context once the built objects are complete on the GPU.
+void virtual_screen_shared_build(config_display *display, render_output *render, config_virtual_screen *config, void **data);
+void virtual_screen_monitor_build(config_display* display, config_virtual_screen* config, void* data);
+void virtual_screen_shared_attach(config_virtual_screen *config, void *data);
+void virtual_screen_monitor_attach(void* data);
+
+// Recreate only the resources affected by changes (CONFIG_VS_CHANGE_* flags)
+void virtual_screen_shared_update(config_display *display, render_output *render, config_virtual_screen *config, void *data, int changes);
+void virtual_screen_monitor_update(config_display *display, render_output *render, config_virtual_screen *config, void *data, int changes);
+
+// Mesh changes keeping the vertex and index counts, e.g. calibration nudges,
+// patch the changed buffer ranges instead of rebuilding the mesh. previous
+// is the config the buffers were loaded from, its mesh must still be alive.
+int virtual_screen_monitor_can_patch(config_virtual_screen *previous, config_virtual_screen *config, int changes);
+void virtual_screen_monitor_patch(config_virtual_screen *previous, config_virtual_screen *config, void *data);
+
+void virtual_screen_shared_create_measures(void *data, int display_index, int virtual_screen_index);
+
 void virtual_screen_shared_render(config_virtual_screen *config, void *data);
-void virtual_screen_monitor_print(config_virtual_screen *config, void *data);
+// width, height: monitor framebuffer size. Draws are scissored to the
+// visible bounds, GL_SCISSOR_TEST must be enabled.
+void virtual_screen_monitor_print(config_virtual_screen *config, void *data, int width, int height);
 
 void virtual_screen_shared_stop(void *data);
 void virtual_screen_monitor_stop(void* data);
@@ -5,14 +5,16 @@ void vs_black_level_adjust_render(config_virtual_screen *config) {
         return;
     }
 
+    ogl_use_program(0);
+
     glEnable(GL_COLOR_MATERIAL);
 
-    glBlendEquation(GL_FUNC_ADD);
-    glBlendFunc(GL_ONE, GL_DST_ALPHA);
+    ogl_blend_equation(GL_FUNC_ADD);
+    ogl_blend_func(GL_ONE, GL_DST_ALPHA);
     
     glColor4f(0.0, 0.0, 0.0, 1.0);
 
-    glBegin(GL_QUADS);
+    ogl_begin(GL_QUADS);
 
     glVertex2d(0.0, 0.0);
     glVertex2d(0.0, config->h);
@@ -21,8 +23,8 @@ void vs_black_level_adjust_render(config_virtual_screen *config) {
 
     glEnd();
 
-    glBlendEquation(GL_MAX);
-    glBlendFunc(GL_ONE, GL_ONE);
+    ogl_blend_equation(GL_MAX);
+    ogl_blend_func(GL_ONE, GL_ONE);
 
     for (int i = 0; i < config->count_black_level_adjusts; i++) {
         config_black_level_adjust *bla = &config->black_level_adjusts[i];
@@ -33,7 +35,7 @@ void vs_black_level_adjust_render(config_virtual_screen *config) {
             bla->color.b * bla->color.a,
             1.0);
 
-        glBegin(GL_QUADS);
+        ogl_begin(GL_QUADS);
 
         glVertex2d(bla->x1, bla->y1);
         glVertex2d(bla->x2, bla->y2);
@@ -43,8 +45,8 @@ void vs_black_level_adjust_render(config_virtual_screen *config) {
         glEnd();
     }
 
-    glBlendEquation(GL_FUNC_ADD);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    ogl_blend_equation(GL_FUNC_ADD);
+    ogl_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     glBlendColor(0.0, 0.0, 0.0, 0.0);
 
     glDisable(GL_COLOR_MATERIAL);
@@ -4,6 +4,7 @@
 
 #include "ogl-loader.h"
 #include "debug.h"
+#include "config.h"
 #include "vs-blend.h"
 
 static const GLfloat UV_VS_BLEND_MODE[4][8] = {
@@ -58,19 +59,10 @@ void vs_blend_initialize() {
 
     curveExponentUniform = glGetUniformLocation(program, "curveExponent");
 
-    glUseProgram(0);
+    ogl_use_program(0);
 }
 
 void vs_blend_load_coordinates(config_virtual_screen *virtual_screen, config_blend *config, vs_blend_info* data) {
-    GLuint vertexarray;
-    
-    glUseProgram(program);
-    
-    glGenVertexArrays(1, &vertexarray);
-    glBindVertexArray(vertexarray);
-
-    data->vertexarray = vertexarray;
-
     GLfloat *indexed_vertices = calloc(16, sizeof(GLfloat));
 
     GLfloat x, y, w, h;
@@ -108,9 +100,6 @@ void vs_blend_load_coordinates(config_virtual_screen *virtual_screen, config_ble
     glGenBuffers(1, &vertexbuffer);
     glBindBuffer(GL_ARRAY_BUFFER, vertexbuffer);
     glBufferData(GL_ARRAY_BUFFER, 16 * sizeof(GLfloat), indexed_vertices, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, 0);
-
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 
     data->vertexbuffer = vertexbuffer;
@@ -120,19 +109,14 @@ void vs_blend_load_coordinates(config_virtual_screen *virtual_screen, config_ble
     glGenBuffers(1, &uvbuffer);
     glBindBuffer(GL_ARRAY_BUFFER, uvbuffer);
     glBufferData(GL_ARRAY_BUFFER, 8 * sizeof(GLfloat), UV_VS_BLEND_MODE[config->direction], GL_STATIC_DRAW);
-
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, 0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 
     data->uvbuffer = uvbuffer;
 
-    glBindVertexArray(0);
-    glUseProgram(0);
-
     data->curve_exponent = config->curve_exponent;
 }
 
-void vs_blend_start(config_virtual_screen *virtual_screen, vs_blend *instance) {
+void vs_blend_build(config_virtual_screen *virtual_screen, vs_blend *instance) {
     instance->info = (vs_blend_info*) calloc(virtual_screen->count_blends, sizeof(vs_blend_info));
     instance->count_info = virtual_screen->count_blends;
 
@@ -141,42 +125,50 @@ void vs_blend_start(config_virtual_screen *virtual_screen, vs_blend *instance) {
     }
 }
 
-void vs_blend_render(vs_blend *instance) {
-    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
-    glColor4d(1.0, 1.0, 1.0, 1.0);
+void vs_blend_attach(vs_blend *instance) {
+    for (int i = 0; i < instance->count_info; i++) {
+        vs_blend_info *data = &instance->info[i];
+        data->vertexarray = ogl_create_vertex_array(data->vertexbuffer, 4, data->uvbuffer);
+    }
+}
 
-    glBindTexture(GL_TEXTURE_2D, 0);
+void vs_blend_start(config_virtual_screen *virtual_screen, vs_blend *instance) {
+    vs_blend_build(virtual_screen, instance);
+    vs_blend_attach(instance);
+}
 
-    glUseProgram(program);
+void vs_blend_update(config_virtual_screen *virtual_screen, vs_blend *instance, int changes) {
+    if (changes & (CONFIG_VS_CHANGE_BLEND_GEOMETRY | CONFIG_VS_CHANGE_SIZE)) {
+        vs_blend_stop(instance);
+        vs_blend_start(virtual_screen, instance);
+    } else if (changes & CONFIG_VS_CHANGE_BLEND_CURVE) {
+        for (int i = 0; i < instance->count_info; i++) {
+            instance->info[i].curve_exponent = virtual_screen->blends[i].curve_exponent;
+        }
+    }
+}
 
-    for (int i = 0; i < instance->count_info; i++) {
-        glUniform1f(curveExponentUniform, instance->info[i].curve_exponent);
+void vs_blend_render(vs_blend *instance) {
+    if (instance->count_info == 0) {
+        return;
+    }
 
-        glBindVertexArray(instance->info[i].vertexarray);
-        glEnableVertexAttribArray(0);
-        glEnableVertexAttribArray(1);
+    ogl_blend_func(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
 
-        glDrawArrays(GL_QUADS, 0, 4);
+    ogl_use_program(program);
 
-        glDisableVertexAttribArray(0);
-        glDisableVertexAttribArray(1);
-        glBindVertexArray(0);
-    }
+    for (int i = 0; i < instance->count_info; i++) {
+        ogl_uniform_1f(curveExponentUniform, instance->info[i].curve_exponent);
 
-    glUseProgram(0);
+        ogl_bind_vertex_array(instance->info[i].vertexarray);
+        ogl_draw_arrays(GL_QUADS, 0, 4);
+    }
 }
 
 void vs_blend_stop(vs_blend *instance) {
     for (int i = 0; i < instance->count_info; i++) {
         vs_blend_info *data = &instance->info[i];
 
-        // Select the VAO
-        glBindVertexArray(data->vertexarray);
-
-        // Disable the VBO index from the VAO attributes list
-        glDisableVertexAttribArray(0);
-        glDisableVertexAttribArray(1);
-
         // Delete the vertex VBO
         glBindBuffer(GL_ARRAY_BUFFER, 0);
         glDeleteBuffers(1, &data->vertexbuffer);
@@ -186,19 +178,18 @@ void vs_blend_stop(vs_blend *instance) {
         glDeleteBuffers(1, &data->uvbuffer);
 
         // Delete the VAO
-        glBindVertexArray(0);
-        glDeleteVertexArrays(1, &data->vertexarray);
+        ogl_delete_vertex_arrays(1, &data->vertexarray);
     }
 
     free(instance->info);
 }
 
 void vs_blend_shutdown() {
-    glUseProgram(0);
+    ogl_use_program(0);
 
     glDetachShader(program, vertexshader);
     glDetachShader(program, fragmentshader);
     glDeleteShader(vertexshader);
     glDeleteShader(fragmentshader);
-    glDeleteProgram(program);
+    ogl_delete_program(program);
 }
@@ -17,7 +17,13 @@ typedef struct {
 } vs_blend;
 
 void vs_blend_initialize();
+// Build creates the buffers on any context of the share group,
+// attach creates the VAOs on the drawing context.
+void vs_blend_build(config_virtual_screen *virtual_screen, vs_blend *instance);
+void vs_blend_attach(vs_blend *instance);
+
 void vs_blend_start(config_virtual_screen *virtual_screen, vs_blend *instance);
+void vs_blend_update(config_virtual_screen *virtual_screen, vs_blend *instance, int changes);
 void vs_blend_render(vs_blend *instance);
 void vs_blend_stop(vs_blend *instance);
 void vs_blend_shutdown();
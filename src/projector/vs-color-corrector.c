@@ -3,6 +3,7 @@
 #include <string.h>
 
 #include "debug.h"
+#include "config.h"
 #include "vs-color-corrector.h"
 
 static GLuint vertexshader;
@@ -55,18 +56,44 @@ void vs_color_corrector_init() {
 
     colorMapData = calloc(CONFIG_COLOR_CORRECTOR_LENGTH, sizeof(GLfloat));
 
-    glUseProgram(0);
+    ogl_use_program(program);
+    ogl_uniform_1i(textureUniform, 0);
+    ogl_use_program(0);
 }
 
-void vs_color_corrector_start(config_virtual_screen *config, render_output *render, vs_color_corrector *data) {
-    GLuint vertexarray;
-    glUseProgram(program);
-    
-    glGenVertexArrays(1, &vertexarray);
-    glBindVertexArray(vertexarray);
+static void vs_color_corrector_load_uvs(config_virtual_screen *config, render_output *render, vs_color_corrector *data) {
+    float x, y, w, h;
+
+    x = config->render_input_bounds.x / (float) render->size.render_width;
+    y = config->render_input_bounds.y / (float) render->size.render_height;
+    w = config->render_input_bounds.w / (float) render->size.render_width;
+    h = config->render_input_bounds.h / (float) render->size.render_height;
+
+    GLfloat *indexed_uvs = calloc(8, sizeof(GLfloat));
+
+    indexed_uvs[0] = x;
+    indexed_uvs[1] = y;
+
+    indexed_uvs[2] = x;
+    indexed_uvs[3] = y + h;
+
+    indexed_uvs[4] = x + w;
+    indexed_uvs[5] = y + h;
+
+    indexed_uvs[6] = x + w;
+    indexed_uvs[7] = y;
+
+    glBindBuffer(GL_ARRAY_BUFFER, data->uvbuffer);
+    glBufferData(GL_ARRAY_BUFFER, 8 * sizeof(GLfloat), indexed_uvs, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    free(indexed_uvs);
 
-    data->vertexarray = vertexarray;
+    data->render_width = render->size.render_width;
+    data->render_height = render->size.render_height;
+}
 
+void vs_color_corrector_build(config_virtual_screen *config, render_output *render, vs_color_corrector *data) {
     GLfloat *indexed_vertices = calloc(16, sizeof(GLfloat));
 
     indexed_vertices[0] = -1.0;
@@ -93,80 +120,67 @@ void vs_color_corrector_start(config_virtual_screen *config, render_output *rend
     glGenBuffers(1, &vertexbuffer);
     glBindBuffer(GL_ARRAY_BUFFER, vertexbuffer);
     glBufferData(GL_ARRAY_BUFFER, 16 * sizeof(GLfloat), indexed_vertices, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, 0);
-
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 
     data->vertexbuffer = vertexbuffer;
     free(indexed_vertices);
 
-    float x, y, w, h;
-
-    x = config->render_input_bounds.x / (float) render->size.render_width;
-    y = config->render_input_bounds.y / (float) render->size.render_height;
-    w = config->render_input_bounds.w / (float) render->size.render_width;
-    h = config->render_input_bounds.h / (float) render->size.render_height;
-
-    GLfloat *indexed_uvs = calloc(8, sizeof(GLfloat));
-
-    indexed_uvs[0] = x;
-    indexed_uvs[1] = y;
-
-    indexed_uvs[2] = x;
-    indexed_uvs[3] = y + h;
-
-    indexed_uvs[4] = x + w;
-    indexed_uvs[5] = y + h;
-
-    indexed_uvs[6] = x + w;
-    indexed_uvs[7] = y;
-
     GLuint uvbuffer;
     glGenBuffers(1, &uvbuffer);
-    glBindBuffer(GL_ARRAY_BUFFER, uvbuffer);
-    glBufferData(GL_ARRAY_BUFFER, 8 * sizeof(GLfloat), indexed_uvs, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, 0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
 
     data->uvbuffer = uvbuffer;
-    free(indexed_uvs);
+    vs_color_corrector_load_uvs(config, render, data);
+}
 
-    glBindVertexArray(0);
-    glUseProgram(0);
+void vs_color_corrector_attach(vs_color_corrector *data) {
+    data->vertexarray = ogl_create_vertex_array(data->vertexbuffer, 4, data->uvbuffer);
+}
+
+void vs_color_corrector_start(config_virtual_screen *config, render_output *render, vs_color_corrector *data) {
+    vs_color_corrector_build(config, render, data);
+    vs_color_corrector_attach(data);
+}
+
+void vs_color_corrector_update(config_virtual_screen *config, render_output *render, vs_color_corrector *data, int changes) {
+    int render_resized =
+        data->render_width != render->size.render_width ||
+        data->render_height != render->size.render_height;
+
+    if (render_resized || (changes & CONFIG_VS_CHANGE_INPUT_BOUNDS)) {
+        vs_color_corrector_load_uvs(config, render, data);
+    }
 }
 
 void vs_color_corrector_set_uniforms(config_virtual_screen *config) {
-    glUniform3f(
+    ogl_uniform_3f(
         redMatrixUniform, 
         config->color_matrix.r_to_r,
         config->color_matrix.r_to_g,
         config->color_matrix.r_to_b
     );
 
-    glUniform3f(
+    ogl_uniform_3f(
         greenMatrixUniform,
         config->color_matrix.g_to_r,
         config->color_matrix.g_to_g,
         config->color_matrix.g_to_b
     );
 
-    glUniform3f(
+    ogl_uniform_3f(
         blueMatrixUniform,
         config->color_matrix.b_to_r,
         config->color_matrix.b_to_g,
         config->color_matrix.b_to_b
     );
 
-    glUniform3f(
+    ogl_uniform_3f(
         exposureMatrixUniform,
         config->color_matrix.r_exposure,
         config->color_matrix.g_exposure,
         config->color_matrix.b_exposure
     );
 
-    glUniform3f(
+    ogl_uniform_3f(
         brightMatrixUniform,
         config->color_matrix.r_bright,
         config->color_matrix.g_bright,
@@ -178,31 +192,31 @@ void vs_color_corrector_set_uniforms(config_virtual_screen *config) {
         colorMapData[i] = config->color_corrector[i].src_lum;
     }
 
-    glUniform1fv(lumSrcMapUniform, CONFIG_COLOR_CORRECTOR_LENGTH, colorMapData);
+    ogl_uniform_1fv(lumSrcMapUniform, CONFIG_COLOR_CORRECTOR_LENGTH, colorMapData);
 
     for (int i = 0; i < CONFIG_COLOR_CORRECTOR_LENGTH; i++) {
         colorMapData[i] = config->color_corrector[i].src_q;
     }
 
-    glUniform1fv(lumQSrcMapUniform, CONFIG_COLOR_CORRECTOR_LENGTH, colorMapData);
+    ogl_uniform_1fv(lumQSrcMapUniform, CONFIG_COLOR_CORRECTOR_LENGTH, colorMapData);
     
     for (int i = 0; i < CONFIG_COLOR_CORRECTOR_LENGTH; i++) {
         colorMapData[i] = config->color_corrector[i].dst_hue;
     }
     
-    glUniform1fv(hueDstMapUniform, CONFIG_COLOR_CORRECTOR_LENGTH, colorMapData);
+    ogl_uniform_1fv(hueDstMapUniform, CONFIG_COLOR_CORRECTOR_LENGTH, colorMapData);
 
     for (int i = 0; i < CONFIG_COLOR_CORRECTOR_LENGTH; i++) {
         colorMapData[i] = config->color_corrector[i].dst_sat;
     }
 
-    glUniform1fv(satDstMapUniform, CONFIG_COLOR_CORRECTOR_LENGTH, colorMapData);
+    ogl_uniform_1fv(satDstMapUniform, CONFIG_COLOR_CORRECTOR_LENGTH, colorMapData);
     
     for (int i = 0; i < CONFIG_COLOR_CORRECTOR_LENGTH; i++) {
         colorMapData[i] = config->color_corrector[i].dst_lum;
     }
 
-    glUniform1fv(lumDstMapUniform, CONFIG_COLOR_CORRECTOR_LENGTH, colorMapData);
+    ogl_uniform_1fv(lumDstMapUniform, CONFIG_COLOR_CORRECTOR_LENGTH, colorMapData);
 }
 
 
@@ -213,44 +227,20 @@ void vs_color_corrector_render(config_virtual_screen *config, render_output *ren
         return;
     }
 
-    glEnable(GL_TEXTURE_2D);
+    ogl_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glColor4f(1.0, 1.0, 1.0, 1.0);
-
-    glUseProgram(program);
+    ogl_use_program(program);
 
     vs_color_corrector_set_uniforms(config);
 
-    glBindTexture(GL_TEXTURE_2D, texture_id);
-    glActiveTexture(GL_TEXTURE0);
-    glUniform1i(textureUniform, 0);
-
-    glBindVertexArray(data->vertexarray);
-    glEnableVertexAttribArray(0);
-    glEnableVertexAttribArray(1);
-
-    glDrawArrays(GL_QUADS, 0, 4);
-
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glDisableVertexAttribArray(0);
-    glDisableVertexAttribArray(1);
-    glBindVertexArray(0);
-
-    glUseProgram(0);
-
-    glDisable(GL_TEXTURE_2D);
+    ogl_active_texture(GL_TEXTURE0);
+    ogl_bind_texture(GL_TEXTURE_2D, texture_id);
 
+    ogl_bind_vertex_array(data->vertexarray);
+    ogl_draw_arrays(GL_QUADS, 0, 4);
 }
 
 void vs_color_corrector_stop(vs_color_corrector *data) {
-    // Select the VAO
-    glBindVertexArray(data->vertexarray);
-
-    // Disable the VBO index from the VAO attributes list
-    glDisableVertexAttribArray(0);
-    glDisableVertexAttribArray(1);
-
     // Delete the vertex VBO
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glDeleteBuffers(1, &data->vertexbuffer);
@@ -260,18 +250,17 @@ void vs_color_corrector_stop(vs_color_corrector *data) {
     glDeleteBuffers(1, &data->uvbuffer);
 
     // Delete the VAO
-    glBindVertexArray(0);
-    glDeleteVertexArrays(1, &data->vertexarray);
+    ogl_delete_vertex_arrays(1, &data->vertexarray);
 }
 
 void vs_color_corrector_shutdown() {
-    glUseProgram(0);
+    ogl_use_program(0);
 
     glDetachShader(program, vertexshader);
     glDetachShader(program, fragmentshader);
     glDeleteShader(vertexshader);
     glDeleteShader(fragmentshader);
-    glDeleteProgram(program);
+    ogl_delete_program(program);
 
     free(colorMapData);
 }
@@ -10,10 +10,19 @@ typedef struct {
     GLuint vertexarray;
     GLuint vertexbuffer;
     GLuint uvbuffer;
+
+    // Render size the UVs were computed for
+    int render_width, render_height;
 } vs_color_corrector;
 
 void vs_color_corrector_init();
+// Build creates the buffers and may run on any context sharing objects with
+// the render context. Attach creates the VAO on the context that draws it.
+void vs_color_corrector_build(config_virtual_screen *config, render_output *render, vs_color_corrector *data);
+void vs_color_corrector_attach(vs_color_corrector *data);
+
 void vs_color_corrector_start(config_virtual_screen *config, render_output *render, vs_color_corrector *data);
+void vs_color_corrector_update(config_virtual_screen *config, render_output *render, vs_color_corrector *data, int changes);
 void vs_color_corrector_render(config_virtual_screen *config, render_output *render, vs_color_corrector *data);
 void vs_color_corrector_stop(vs_color_corrector *data);
 void vs_color_corrector_shutdown();
@@ -2,7 +2,12 @@
 #include "ogl-loader.h"
 
 void vs_help_lines_render(config_virtual_screen *config) {
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    if (config->count_help_lines <= 0) {
+        return;
+    }
+
+    ogl_use_program(0);
+    ogl_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     glEnable(GL_LINE_SMOOTH);
 
@@ -13,7 +18,7 @@ void vs_help_lines_render(config_virtual_screen *config) {
 
         glLineWidth(line->line_width);
 
-        glBegin(GL_LINES);
+        ogl_begin(GL_LINES);
         glVertex2d(line->x1, line->y1);
         glVertex2d(line->x2, line->y2);
         glEnd();
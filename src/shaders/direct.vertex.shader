@@ -1,9 +1,12 @@
-attribute vec4 in_Position;
+attribute vec2 in_Position;
 attribute vec2 in_Uv;
 
+// Mesh bounding box in clip space: x, y, w, h
+uniform vec4 position_bounds;
+
 varying vec2 frag_Uv;
 
 void main(void) {
-    gl_Position = in_Position;
+    gl_Position = vec4(position_bounds.xy + (in_Position * position_bounds.zw), 0.0, 1.0);
     frag_Uv = in_Uv;
 }
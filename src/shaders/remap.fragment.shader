@@ -0,0 +1,19 @@
+varying vec2 frag_Uv;
+
+uniform sampler2D image;
+uniform sampler2D remap;
+uniform vec2 adjust_factor;
+
+// Unsigned shorts: u, v of 0..65534, u of 65535 where the mesh does not reach
+void main(void) {
+    vec2 uv = texture2D(remap, frag_Uv).rg;
+
+    if (uv.r > 65534.5 / 65535.0) {
+        discard;
+    }
+
+    vec2 result = pow(uv * (65535.0 / 65534.0), adjust_factor);
+    vec4 color = texture2D(image, result);
+
+    gl_FragColor = color;
+}
@@ -0,0 +1,9 @@
+attribute vec2 in_Position;
+attribute vec2 in_Uv;
+
+varying vec2 frag_Uv;
+
+void main(void) {
+    gl_Position = vec4(in_Position, 0.0, 1.0);
+    frag_Uv = in_Uv;
+}
@@ -357,6 +357,7 @@
 #endif /* LINUX */
 #ifdef TRILIBRARY
 #include "triangle.h"
+#include "tinycthread.h"
 #endif /* TRILIBRARY */
 
 /* A few forward declarations.                                               */
@@ -650,9 +651,14 @@ REAL ccwerrboundA, ccwerrboundB, ccwerrboundC;
 REAL iccerrboundA, iccerrboundB, iccerrboundC;
 REAL o3derrboundA, o3derrboundB, o3derrboundC;
 
-/* Random number seed is not constant, but I've made it global anyway.       */
+/* Random number seed is not constant, it is kept per thread so separate     */
+/*   meshes can be triangulated concurrently.                                */
 
-__UINT64 randomseed;                     /* Current random number seed. */
+_Thread_local __UINT64 randomseed;       /* Current random number seed. */
+
+/* The constants above are computed once, by the first exactinit() call.     */
+
+once_flag exactinitonce = ONCE_FLAG_INIT;
 
 
 /* Mesh data structure.  Triangle operates on only one mesh, but the mesh    */
@@ -4885,32 +4891,11 @@ struct osub *newsubseg;
 /*                                                                           */
 /*****************************************************************************/
 
-void exactinit()
+void exactinitconstants()
 {
   REAL half;
   REAL check, lastcheck;
   int every_other;
-#ifdef LINUX
-  int cword;
-#endif /* LINUX */
-
-#ifdef CPU86
-#ifdef SINGLE
-  _control87(_PC_24, _MCW_PC); /* Set FPU control word for single precision. */
-#else /* not SINGLE */
-  _control87(_PC_53, _MCW_PC); /* Set FPU control word for double precision. */
-#endif /* not SINGLE */
-#endif /* CPU86 */
-#ifdef LINUX
-#ifdef SINGLE
-  /*  cword = 4223; */
-  cword = 4210;                 /* set FPU control word for single precision */
-#else /* not SINGLE */
-  /*  cword = 4735; */
-  cword = 4722;                 /* set FPU control word for double precision */
-#endif /* not SINGLE */
-  _FPU_SETCW(cword);
-#endif /* LINUX */
 
   every_other = 1;
   half = 0.5;
@@ -4944,6 +4929,34 @@ void exactinit()
   o3derrboundC = (26.0 + 288.0 * epsilon) * epsilon * epsilon;
 }
 
+void exactinit()
+{
+#ifdef LINUX
+  int cword;
+#endif /* LINUX */
+
+#ifdef CPU86
+#ifdef SINGLE
+  _control87(_PC_24, _MCW_PC); /* Set FPU control word for single precision. */
+#else /* not SINGLE */
+  _control87(_PC_53, _MCW_PC); /* Set FPU control word for double precision. */
+#endif /* not SINGLE */
+#endif /* CPU86 */
+#ifdef LINUX
+#ifdef SINGLE
+  /*  cword = 4223; */
+  cword = 4210;                 /* set FPU control word for single precision */
+#else /* not SINGLE */
+  /*  cword = 4735; */
+  cword = 4722;                 /* set FPU control word for double precision */
+#endif /* not SINGLE */
+  _FPU_SETCW(cword);
+#endif /* LINUX */
+
+  /* The FPU control word is set per thread, the constants only once. */
+  call_once(&exactinitonce, exactinitconstants);
+}
+
 /*****************************************************************************/
 /*                                                                           */
 /*  fast_expansion_sum_zeroelim()   Sum two expansions, eliminating zero     */